@@ -0,0 +1,166 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <compiler/arena.h>
+
+void compiler_arena_init(compiler_arena_t *arena)
+{
+    arena->chunk = NULL;
+    arena->last = NULL;
+}
+
+void compiler_arena_release(compiler_arena_t *arena)
+{
+    /* releasing all chunks at once */
+    compiler_arena_chunk_t *chunk = arena->chunk;
+    while(chunk != NULL)
+    {
+        compiler_arena_chunk_t *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    arena->chunk = NULL;
+    arena->last = NULL;
+}
+
+void compiler_arena_adopt(compiler_arena_t *arena,
+                          compiler_arena_t *other)
+{
+    /* finding the end of the others chunk list */
+    compiler_arena_chunk_t *tail = other->chunk;
+    if(tail == NULL)
+    {
+        return;
+    }
+    while(tail->next != NULL)
+    {
+        tail = tail->next;
+    }
+
+    /* splicing it in behind the current chunk, so bumping carries on where it was */
+    if(arena->chunk == NULL)
+    {
+        arena->chunk = other->chunk;
+    }
+    else
+    {
+        tail->next = arena->chunk->next;
+        arena->chunk->next = other->chunk;
+    }
+
+    other->chunk = NULL;
+    other->last = NULL;
+}
+
+static void compiler_arena_chunk_new(compiler_arena_t *arena,
+                                     size_t size)
+{
+    /* oversized allocations get a chunk of their own */
+    if(size < COMPILER_ARENA_CHUNK_SIZE)
+    {
+        size = COMPILER_ARENA_CHUNK_SIZE;
+    }
+
+    compiler_arena_chunk_t *chunk = malloc(sizeof(compiler_arena_chunk_t) + size);
+
+    /* null pointer check */
+    if(chunk == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+
+    chunk->next = arena->chunk;
+    chunk->size = size;
+    chunk->used = 0;
+    arena->chunk = chunk;
+}
+
+void *compiler_arena_alloc(compiler_arena_t *arena,
+                           size_t size)
+{
+    /* keeping every allocation aligned */
+    size = (size + (COMPILER_ARENA_ALIGN - 1)) & ~(size_t)(COMPILER_ARENA_ALIGN - 1);
+
+    /* checking if current chunk has room left */
+    if(arena->chunk == NULL || arena->chunk->size - arena->chunk->used < size)
+    {
+        compiler_arena_chunk_new(arena, size);
+    }
+
+    void *ptr = &arena->chunk->data[arena->chunk->used];
+    arena->chunk->used += size;
+    arena->last = ptr;
+    return ptr;
+}
+
+void *compiler_arena_calloc(compiler_arena_t *arena,
+                            size_t cnt,
+                            size_t size)
+{
+    void *ptr = compiler_arena_alloc(arena, cnt * size);
+    memset(ptr, 0, cnt * size);
+    return ptr;
+}
+
+void *compiler_arena_realloc(compiler_arena_t *arena,
+                             void *ptr,
+                             size_t old_size,
+                             size_t new_size)
+{
+    if(ptr == NULL)
+    {
+        return compiler_arena_alloc(arena, new_size);
+    }
+
+    /* the last allocation can grow in place if its chunk has room */
+    if(ptr == arena->last)
+    {
+        size_t offset = (unsigned char*)ptr - arena->chunk->data;
+        size_t aligned = (new_size + (COMPILER_ARENA_ALIGN - 1)) & ~(size_t)(COMPILER_ARENA_ALIGN - 1);
+        if(offset + aligned <= arena->chunk->size)
+        {
+            arena->chunk->used = offset + aligned;
+            return ptr;
+        }
+    }
+
+    /* otherwise moving it, the old copy is released with the arena */
+    void *new_ptr = compiler_arena_alloc(arena, new_size);
+    memcpy(new_ptr, ptr, (old_size < new_size) ? old_size : new_size);
+    return new_ptr;
+}
+
+char *compiler_arena_strdup(compiler_arena_t *arena,
+                            const char *str)
+{
+    size_t len = strlen(str);
+    char *dup = compiler_arena_alloc(arena, len + 1);
+    memcpy(dup, str, len + 1);
+    return dup;
+}
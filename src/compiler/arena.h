@@ -0,0 +1,54 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef COMPILER_ARENA_H
+#define COMPILER_ARENA_H
+
+#include <stddef.h>
+
+#define COMPILER_ARENA_CHUNK_SIZE   0x10000
+#define COMPILER_ARENA_ALIGN        16
+
+typedef struct compiler_arena_chunk {
+    struct compiler_arena_chunk *next;      /* previously filled chunk */
+    size_t size;                            /* usable size of data */
+    size_t used;                            /* bytes handed out of data */
+    unsigned char data[];
+} compiler_arena_chunk_t;
+
+typedef struct {
+    compiler_arena_chunk_t *chunk;          /* chunk currently bumped from */
+    void *last;                             /* last allocation, it can grow in place */
+} compiler_arena_t;
+
+void compiler_arena_init(compiler_arena_t *arena);
+void compiler_arena_release(compiler_arena_t *arena);
+void compiler_arena_adopt(compiler_arena_t *arena, compiler_arena_t *other);
+
+void *compiler_arena_alloc(compiler_arena_t *arena, size_t size);
+void *compiler_arena_calloc(compiler_arena_t *arena, size_t cnt, size_t size);
+void *compiler_arena_realloc(compiler_arena_t *arena, void *ptr, size_t old_size, size_t new_size);
+char *compiler_arena_strdup(compiler_arena_t *arena, const char *str);
+
+#endif /* COMPILER_ARENA_H */
@@ -0,0 +1,218 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <compiler/cache.h>
+#include <compiler/object.h>
+#include <compiler/error.h>
+
+static uint32_t cache_options(compiler_invocation_t *ci)
+{
+    return ci->optimize ? COMPILER_CACHE_OPTION_OPTIMIZE : 0;
+}
+
+/* 64bit FNV-1a over the source, seeded with the versions and options that shape the object */
+static uint64_t cache_hash(const char *buf,
+                           size_t len,
+                           uint32_t options)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    uint64_t version = ((uint64_t)options << 32) | (COMPILER_CACHE_ASSEMBLER_VERSION << 16) | COMPILER_OBJECT_VERSION;
+    for(size_t i = 0; i < sizeof(version); i++)
+    {
+        hash ^= (version >> (i * 8)) & 0xFF;
+        hash *= 0x100000001B3ULL;
+    }
+    for(size_t i = 0; i < len; i++)
+    {
+        hash ^= (unsigned char)buf[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+char *cache_path(compiler_invocation_t *ci,
+                 const char *dir)
+{
+    size_t len = strlen(ci->code);
+    size_t size = strlen(dir) + 32;
+    char *path = compiler_arena_alloc(&ci->arena, size);
+    snprintf(path, size, "%s/%016llx.lc", dir, (unsigned long long)cache_hash(ci->code, len, cache_options(ci)));
+    return path;
+}
+
+static bool cache_mkdir(char *path)
+{
+    /* creating every missing directory along the path */
+    for(char *p = path + 1; *p != '\0'; p++)
+    {
+        if(*p == '/')
+        {
+            *p = '\0';
+            int ret = mkdir(path, 0755);
+            *p = '/';
+            if(ret < 0 && errno != EEXIST)
+            {
+                return false;
+            }
+        }
+    }
+    return mkdir(path, 0755) == 0 || errno == EEXIST;
+}
+
+char *cache_dir(compiler_invocation_t *ci)
+{
+    /* LA16_CACHE_DIR wins, LA16_NO_CACHE turns the cache off */
+    if(getenv("LA16_NO_CACHE") != NULL)
+    {
+        return NULL;
+    }
+
+    const char *env = getenv("LA16_CACHE_DIR");
+    const char *suffix = "";
+    if(env == NULL || env[0] == '\0')
+    {
+        env = getenv("XDG_CACHE_HOME");
+        suffix = "/la16";
+        if(env == NULL || env[0] == '\0')
+        {
+            env = getenv("HOME");
+            suffix = "/.cache/la16";
+        }
+    }
+
+    if(env == NULL || env[0] == '\0')
+    {
+        return NULL;
+    }
+
+    size_t size = strlen(env) + strlen(suffix) + 1;
+    char *dir = compiler_arena_alloc(&ci->arena, size);
+    snprintf(dir, size, "%s%s", env, suffix);
+
+    /* a cache that cannot be created is simply not used */
+    if(!cache_mkdir(dir))
+    {
+        return NULL;
+    }
+    return dir;
+}
+
+bool cache_load(compiler_invocation_t *ci,
+                const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+    {
+        return false;
+    }
+
+    struct stat fdstat;
+    if(fstat(fd, &fdstat) < 0 || (size_t)fdstat.st_size < sizeof(compiler_cache_header_t))
+    {
+        close(fd);
+        return false;
+    }
+
+    unsigned char *buf = compiler_arena_alloc(&ci->arena, fdstat.st_size);
+    ssize_t bytes = read(fd, buf, fdstat.st_size);
+    close(fd);
+
+    if(bytes != fdstat.st_size)
+    {
+        return false;
+    }
+
+    /* the entry has to be for this exact source and assembler */
+    compiler_cache_header_t *header = (compiler_cache_header_t*)buf;
+    size_t source_size = strlen(ci->code);
+    if(header->magic != COMPILER_CACHE_MAGIC ||
+       header->assembler_version != COMPILER_CACHE_ASSEMBLER_VERSION ||
+       header->object_version != COMPILER_OBJECT_VERSION ||
+       header->options != cache_options(ci) ||
+       header->source_size != source_size ||
+       sizeof(compiler_cache_header_t) + header->source_size + header->object_size != (size_t)fdstat.st_size ||
+       memcmp(buf + sizeof(compiler_cache_header_t), ci->code, source_size) != 0)
+    {
+        return false;
+    }
+
+    /* a corrupted entry is a miss, not an error */
+    compiler_object_t object;
+    compiler_trap_t trap;
+    compiler_trap_t *outer = compiler_trap_set(&trap);
+    if(setjmp(trap.jmp) != 0)
+    {
+        compiler_trap_set(outer);
+        return false;
+    }
+    object_deserialize(ci, buf + sizeof(compiler_cache_header_t) + source_size, header->object_size, &object);
+    compiler_trap_set(outer);
+
+    *ci->object = object;
+    return true;
+}
+
+void cache_store(compiler_invocation_t *ci,
+                 const char *path)
+{
+    size_t object_size = 0;
+    void *object = object_serialize(ci, ci->object, &object_size);
+
+    compiler_cache_header_t header = {
+        .magic = COMPILER_CACHE_MAGIC,
+        .assembler_version = COMPILER_CACHE_ASSEMBLER_VERSION,
+        .object_version = COMPILER_OBJECT_VERSION,
+        .options = cache_options(ci),
+        .source_size = strlen(ci->code),
+        .object_size = object_size,
+    };
+
+    /* writing to a temporary file first, so readers never see half an entry */
+    size_t size = strlen(path) + 8;
+    char *tmp = compiler_arena_alloc(&ci->arena, size);
+    snprintf(tmp, size, "%s.XXXXXX", path);
+
+    int fd = mkstemp(tmp);
+    if(fd < 0)
+    {
+        return;
+    }
+
+    bool ok = write(fd, &header, sizeof(header)) == sizeof(header) &&
+              write(fd, ci->code, header.source_size) == (ssize_t)header.source_size &&
+              write(fd, object, object_size) == (ssize_t)object_size;
+    close(fd);
+
+    if(!ok || rename(tmp, path) < 0)
+    {
+        unlink(tmp);
+    }
+}
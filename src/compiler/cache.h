@@ -0,0 +1,59 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef COMPILER_CACHE_H
+#define COMPILER_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <compiler/type.h>
+
+/* has to be bumped whenever the assembler emits different objects for the same source */
+#define COMPILER_CACHE_ASSEMBLER_VERSION    7
+#define COMPILER_CACHE_MAGIC                0x4336314C      /* "L16C" */
+
+#define COMPILER_CACHE_OPTION_OPTIMIZE      0b1     /* assembled with the peephole pass */
+
+/*
+ * A cache entry is the header, the source it was assembled from and
+ * the serialized object, the source is compared on load so a hash
+ * collision can never hand out a wrong object, the options the
+ * source was assembled with are part of the key
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t assembler_version;
+    uint16_t object_version;
+    uint32_t options;
+    uint32_t reserved;
+    uint64_t source_size;
+    uint64_t object_size;
+} compiler_cache_header_t;
+
+char *cache_dir(compiler_invocation_t *ci);
+char *cache_path(compiler_invocation_t *ci, const char *dir);
+bool cache_load(compiler_invocation_t *ci, const char *path);
+void cache_store(compiler_invocation_t *ci, const char *path);
+
+#endif /* COMPILER_CACHE_H */
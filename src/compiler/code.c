@@ -23,7 +23,6 @@
  */
 
 #include <compiler/code.h>
-#include <compiler/cmptok.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
@@ -31,16 +30,18 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <errno.h>
+#include <compiler/error.h>
 
 void get_code_buffer(char **files,
                      int file_cnt,
                      compiler_invocation_t *ci)
 {
     /* allocating array for file descriptor */
-    int *fd = calloc(file_cnt, sizeof(int));
+    int *fd = compiler_arena_calloc(&ci->arena, file_cnt, sizeof(int));
 
     /* allocating array for file statistics */
-    size_t *fdsize = calloc(file_cnt, sizeof(size_t));
+    size_t *fdsize = compiler_arena_calloc(&ci->arena, file_cnt, sizeof(size_t));
 
     /* sizes */
     size_t size_needed = 0;
@@ -52,15 +53,13 @@ void get_code_buffer(char **files,
         fd[i] = open(files[i], O_RDONLY);
         if(fd[i] < 0)
         {
-            perror(files[i]);
-            exit(EXIT_FAILURE);
+            compiler_error(ci, "%s: %s", files[i], strerror(errno));
         }
 
         struct stat fdstat;
         if(fstat(fd[i], &fdstat) < 0)
         {
-            perror("fstat");
-            exit(EXIT_FAILURE);
+            compiler_error(ci, "fstat: %s", strerror(errno));
         }
 
         fdsize[i] = fdstat.st_size;
@@ -70,14 +69,7 @@ void get_code_buffer(char **files,
     size_needed++;
 
     /* allocating buffer for the raw code */
-    char *buf = malloc(size_needed + 1);
-
-    /* null pointer check */
-    if(buf == NULL)
-    {
-        perror("malloc");
-        exit(EXIT_FAILURE);
-    }
+    char *buf = compiler_arena_alloc(&ci->arena, size_needed + 1);
 
     /* read code into buffer*/
     for(int i = 0; i < file_cnt; i++)
@@ -88,8 +80,7 @@ void get_code_buffer(char **files,
         /* checking if bytes in the after math are below 0 */
         if(bytes < 0)
         {
-            perror("read");
-            exit(EXIT_FAILURE);
+            compiler_error(ci, "read: %s", strerror(errno));
         }
 
         /* nice write was successful */
@@ -108,264 +99,392 @@ void get_code_buffer(char **files,
         close(fd[i]);
     }
 
-    /* releasing memory of the arrays we allocated */
-    free(fd);
-    free(fdsize);
+    /* setting code buffer */
+    ci->code = buf;
+}
+
+void get_code_buffer_memory(const char *src,
+                            size_t len,
+                            compiler_invocation_t *ci)
+{
+    /* same layout get_code_buffer produces for a single file */
+    char *buf = compiler_arena_alloc(&ci->arena, len + 3);
+    memcpy(buf, src, len);
+    buf[len] = '\n';
+    buf[len + 1] = '\n';                    /* FIXME: Without this symbols break */
+    buf[len + 2] = '\0';
 
     /* setting code buffer */
     ci->code = buf;
 }
 
-void code_remove_comments(compiler_invocation_t *ci)
+bool code_slice_equal(const compiler_slice_t *slice,
+                      const char *str)
 {
-    size_t i = 0;
-    while (ci->code[i] != '\0')
+    size_t len = strlen(str);
+    return slice->len == len && memcmp(slice->str, str, len) == 0;
+}
+
+char *code_slice_copy(compiler_invocation_t *ci,
+                      const compiler_slice_t *slice,
+                      char *buf,
+                      size_t size)
+{
+    /* checking if slice and null terminator fit */
+    if(slice->len >= size)
     {
-        if (ci->code[i] == ';')
-        {
-            size_t s = i;
-            while (s > 0 && ci->code[s - 1] == ' ')
-            {
-                s--;
-            }
-            if (s == 0 || ci->code[s - 1] == '\n')
-            {
-                i = s;
-            }
+        compiler_error(ci, "\"%.*s\" is too long", (int)slice->len, slice->str);
+    }
 
-            size_t e = i;
-            while (ci->code[e] != '\n' && ci->code[e] != '\0')
-            {
-                e++;
-            }
+    memcpy(buf, slice->str, slice->len);
+    buf[slice->len] = '\0';
+    return buf;
+}
+
+static compiler_token_t *code_token_push(compiler_invocation_t *ci)
+{
+    /* growing token array if needed */
+    if(ci->token_cnt >= ci->token_cap)
+    {
+        unsigned long old_cap = ci->token_cap;
+        ci->token_cap = (ci->token_cap == 0) ? 64 : ci->token_cap * 2;
+        ci->token = compiler_arena_realloc(&ci->arena, ci->token, old_cap * sizeof(compiler_token_t), ci->token_cap * sizeof(compiler_token_t));
+    }
+
+    compiler_token_t *ct = &ci->token[ci->token_cnt++];
+    memset(ct, 0, sizeof(compiler_token_t));
+    ct->subtoken = ci->subtoken_cnt;
+    return ct;
+}
+
+void code_subtoken_push(compiler_invocation_t *ci,
+                        compiler_token_t *ct,
+                        const char *str,
+                        unsigned long len)
+{
+    /* growing subtoken array if needed */
+    if(ci->subtoken_cnt >= ci->subtoken_cap)
+    {
+        unsigned long old_cap = ci->subtoken_cap;
+        ci->subtoken_cap = (ci->subtoken_cap == 0) ? 256 : ci->subtoken_cap * 2;
+        ci->subtoken = compiler_arena_realloc(&ci->arena, ci->subtoken, old_cap * sizeof(compiler_slice_t), ci->subtoken_cap * sizeof(compiler_slice_t));
+    }
 
-            memmove(&ci->code[i], &ci->code[e], strlen(&ci->code[e]) + 1);
-            if (ci->code[i] == '\0')
+    ci->subtoken[ci->subtoken_cnt].str = str;
+    ci->subtoken[ci->subtoken_cnt].len = len;
+    ci->subtoken_cnt++;
+    ct->subtoken_cnt++;
+}
+
+static inline bool code_is_newline(char c)
+{
+    return c == '\n' || c == '\r';
+}
+
+static inline bool code_is_space(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+/*
+ * single pass lexer, every line that carries something becomes a token
+ * and every space separated word of it a subtoken. comments and
+ * whitespace are skipped in place, quoted strings and characters stay in
+ * one subtoken. all slices point straight into the code buffer
+ */
+static void code_lex(compiler_invocation_t *ci)
+{
+    const char *code = ci->code;
+    compiler_token_t *ct = NULL;
+    size_t i = 0;
+
+    while(code[i] != '\0')
+    {
+        if(code_is_newline(code[i]))
+        {
+            /* line is over, next subtoken starts a new token */
+            ct = NULL;
+            i++;
+            continue;
+        }
+        else if(code_is_space(code[i]))
+        {
+            i++;
+            continue;
+        }
+        else if(code[i] == ';')
+        {
+            /* line comment, skipping till the end of the line */
+            while(code[i] != '\0' && !code_is_newline(code[i]))
             {
-                break;
+                i++;
             }
+            continue;
         }
-        else if (ci->code[i] == '/' && ci->code[i + 1] == '*')
+        else if(code[i] == '/' && code[i + 1] == '*')
         {
-            size_t comment_start = i;  // Save BEFORE modifying i
-
-            size_t s = i;
-            while (s > 0 && ci->code[s - 1] == ' ')
+            /* block comment, its newlines dont end the line */
+            i += 2;
+            while(code[i] != '\0' && !(code[i] == '*' && code[i + 1] == '/'))
             {
-                s--;
+                i++;
             }
-            if (s == 0 || ci->code[s - 1] == '\n')
+            if(code[i] != '\0')
             {
-                i = s;
+                i += 2;
             }
+            continue;
+        }
 
-            // Find closing */
-            size_t e = comment_start + 2;
-            while (ci->code[e] != '\0')
+        /* walking till the end of the subtoken */
+        size_t start = i;
+        char quote = '\0';
+        for(; code[i] != '\0'; i++)
+        {
+            if(quote != '\0')
             {
-                if (ci->code[e] == '*' && ci->code[e + 1] == '/')
+                if(code_is_newline(code[i]))
                 {
-                    e += 2;
                     break;
                 }
-                e++;
+                else if(code[i] == '\\' && code[i + 1] != '\0' && !code_is_newline(code[i + 1]))
+                {
+                    i++;
+                }
+                else if(code[i] == quote)
+                {
+                    quote = '\0';
+                }
             }
-
-            // Skip trailing whitespace until newline
-            while (ci->code[e] == ' ')
+            else if(code_is_space(code[i]) || code_is_newline(code[i]) || code[i] == ';' ||
+                    (code[i] == '/' && code[i + 1] == '*'))
             {
-                e++;
+                break;
             }
-
-            memmove(&ci->code[i], &ci->code[e], strlen(&ci->code[e]) + 1);
-            if (ci->code[i] == '\0')
+            else if(code[i] == '"' || code[i] == '\'')
             {
-                break;
+                quote = code[i];
             }
         }
-        else
+
+        /* first subtoken of the line opens a new token */
+        if(ct == NULL)
         {
-            i++;
+            ct = code_token_push(ci);
+            ct->token.str = &code[start];
         }
+
+        code_subtoken_push(ci, ct, &code[start], i - start);
+        ct->token.len = &code[i] - ct->token.str;
     }
 }
 
-void code_remove_newlines(compiler_invocation_t *ci)
+#define PUSH_MAX 7
+
+static const char *push_map[PUSH_MAX] = {
+    "r0", "r1", "r2", "r3", "r4", "r5", "r6"
+};
+
+static compiler_token_t *code_token_emit_asm(compiler_invocation_t *ci,
+                                             const compiler_token_t *call,
+                                             unsigned short *addr)
 {
-    size_t src = 0, dst = 0;
-    bool last_was_newline = true;
-    while (ci->code[src] != '\0')
-    {
-        if (ci->code[src] == '\r' || ci->code[src] == '\n') {
-            if (!last_was_newline) {
-                ci->code[dst++] = '\n';
-                last_was_newline = true;
-            }
-            if (ci->code[src] == '\r' && ci->code[src + 1] == '\n') {
-                src++;
-            }
-            src++;
-            continue;
-        }
-        ci->code[dst++] = ci->code[src++];
-        last_was_newline = false;
-    }
-    ci->code[dst] = '\0';
+    compiler_token_t *ct = code_token_push(ci);
+    ct->type = COMPILER_TOKEN_TYPE_ASM;
+    ct->flags = COMPILER_TOKEN_FLAG_CALL;
+    ct->addr = *addr;
+    ct->token = call->token;
+    *addr += 4;
+    return ct;
 }
 
-void code_replace_tab_with_spaces(compiler_invocation_t *ci)
+/*
+ * expands a call pseudo instruction into push, mov, bl and pop
+ * tokens, they are appended straight to the output token array
+ */
+static void code_tokengen_call(compiler_invocation_t *ci,
+                               const compiler_token_t *call,
+                               const compiler_slice_t *call_subtoken,
+                               unsigned short *addr)
 {
-    size_t src = 0;
-    while(ci->code[src] != '\0')
+    unsigned char needed_cycleops = call->subtoken_cnt - 2;
+
+    // Check max args
+    if(call->subtoken_cnt - 2 > PUSH_MAX)
+    {
+        compiler_error(ci, "call can have maximum of %d arguments!", PUSH_MAX);
+    }
+
+    // Extract all subtokens without delimiter, call_subtoken may move once we append
+    compiler_slice_t subtoken[PUSH_MAX + 2];
+    for(unsigned long a = 0; a < call->subtoken_cnt; a++)
     {
-        if(ci->code[src] == '\t')
+        subtoken[a] = call_subtoken[a];
+        if(subtoken[a].len > 0 && subtoken[a].str[subtoken[a].len - 1] == ',')
         {
-            /* replacing with space */
-            ci->code[src] = ' ';
+            subtoken[a].len--;
         }
-        src++;
     }
-}
 
-void code_tokengen(compiler_invocation_t *ci)
-{
-    /* Gathering token count */
-    size_t token_cnt = 0;
-    size_t code_size = strlen(ci->code);
+    // Determine which registers actually need action
+    bool needs_action[PUSH_MAX] = {false};
 
-    for(size_t i = 0; i < code_size; i++)
+    for(unsigned char arg = 0; arg < needed_cycleops; arg++)
     {
-        // Look for '\n'
-        if(ci->code[i] == '\n')
+        // If argument is already in the target register, skip it
+        if(!code_slice_equal(&subtoken[2 + arg], push_map[arg]))
         {
-            token_cnt += 1;
+            needs_action[arg] = true;
         }
     }
 
-    /* Gathering base tokens */
-    ci->token = calloc(token_cnt, sizeof(compiler_token_t));
-    ci->token_cnt = token_cnt;
-
-    token_cnt = 0;
-    size_t last_line_offset = 0;
-    for(size_t i = 0; i < code_size; i++)
+    // Check for conflicts: is any source register going to be clobbered?
+    // Example: call _func, r1, r0  → mov r0, r1; mov r1, r0 (r0 clobbered before read!)
+    bool has_conflict = false;
+    for(unsigned char arg = 0; arg < needed_cycleops && !has_conflict; arg++)
     {
-        // Look for '\n'
-        if(ci->code[i] == '\n')
-        {
-            size_t start_off = last_line_offset;
-            size_t end_off = i;
+        if(!needs_action[arg]) continue;
 
-            for(; start_off < end_off; start_off++)
-            {
-                if(ci->code[start_off] != ' ')
-                {
-                    break;
-                }
-            }
+        const compiler_slice_t *source = &subtoken[2 + arg];
 
-            for(; end_off > start_off; end_off--)
+        // Check if this source is a target register that will be overwritten
+        // by an EARLIER mov (lower index)
+        for(unsigned char earlier = 0; earlier < arg; earlier++)
+        {
+            if(needs_action[earlier] && code_slice_equal(source, push_map[earlier]))
             {
-                if(ci->code[end_off] != ' ' && ci->code[end_off] != '\n')
-                {
-                    end_off++;
-                    break;
-                }
+                has_conflict = true;
+                break;
             }
-
-            size_t len = end_off - start_off;
-            ci->token[token_cnt].token = malloc(len + 1);
-            memcpy(ci->token[token_cnt].token, &(ci->code[start_off]), len);
-            ci->token[token_cnt].token[len] = '\0';
-            last_line_offset = i + 1;
-            token_cnt++;
         }
     }
 
-    /* Gathering their subtokens */
-    for(unsigned long i = 0; i < ci->token_cnt; i++)
+    // If conflict detected, fall back to saving ALL argument registers
+    if(has_conflict)
     {
-        // Get amount of sub tokens
-        ci->token[i].subtoken_cnt = 0;
-        const char *token = cmptok(ci->token[i].token);
-        while(token != NULL)
+        for(unsigned char arg = 0; arg < needed_cycleops; arg++)
         {
-            ci->token[i].subtoken_cnt++;
-            token = cmptok(NULL);
+            needs_action[arg] = true;
         }
+    }
 
-        // Allocate subtoken array
-        ci->token[i].subtoken = calloc(sizeof(char*), ci->token[i].subtoken_cnt);
+    // Generated subtokens point to static mnemonics and the call subtokens
+    compiler_token_t *ct;
 
-        // Get the actual subtokens
-        ci->token[i].subtoken_cnt = 0;
-        token = cmptok(ci->token[i].token);
-        while(token != NULL)
-        {
-            ci->token[i].subtoken[ci->token[i].subtoken_cnt] = strdup(token);
-            ci->token[i].subtoken_cnt++;
-            token = cmptok(NULL);
-        }
+    // Injecting pushes (only for registers that need it)
+    for(unsigned char push = 0; push < needed_cycleops; push++)
+    {
+        if(!needs_action[push]) continue;
+
+        ct = code_token_emit_asm(ci, call, addr);
+        code_subtoken_push(ci, ct, "push", 4);
+        code_subtoken_push(ci, ct, push_map[push], strlen(push_map[push]));
+    }
+
+    // Injecting moves (only for registers that need it)
+    for(unsigned char mov = 0; mov < needed_cycleops; mov++)
+    {
+        if(!needs_action[mov]) continue;
+
+        ct = code_token_emit_asm(ci, call, addr);
+        code_subtoken_push(ci, ct, "mov", 3);
+        code_subtoken_push(ci, ct, push_map[mov], strlen(push_map[mov]));
+        code_subtoken_push(ci, ct, ",", 1);
+        code_subtoken_push(ci, ct, subtoken[2 + mov].str, subtoken[2 + mov].len);
     }
 
+    // Injecting branch link
+    ct = code_token_emit_asm(ci, call, addr);
+    code_subtoken_push(ci, ct, "bl", 2);
+    code_subtoken_push(ci, ct, subtoken[1].str, subtoken[1].len);
+
+    // Injecting pops (reverse order)
+    for(unsigned char pop = 0; pop < needed_cycleops; pop++)
+    {
+        unsigned char pop_idx = needed_cycleops - 1 - pop;
+        if(!needs_action[pop_idx]) continue;
+
+        ct = code_token_emit_asm(ci, call, addr);
+        code_subtoken_push(ci, ct, "pop", 3);
+        code_subtoken_push(ci, ct, push_map[pop_idx], strlen(push_map[pop_idx]));
+    }
+}
+
+void code_tokengen(compiler_invocation_t *ci)
+{
+    /* Lexing the code into tokens and their subtokens */
+    code_lex(ci);
+
+    /*
+     * Classified tokens are emitted into a fresh token array, so
+     * expanding a call appends to it instead of rebuilding it,
+     * the lexed array is released with the arena
+     */
+    compiler_token_t *lexed = ci->token;
+    unsigned long lexed_cnt = ci->token_cnt;
+    ci->token = NULL;
+    ci->token_cnt = 0;
+    ci->token_cap = 0;
+
     /* Evaluate Type and address */
     unsigned short addr = 0x00;
     unsigned char section_mode = 0b0;
-    for(unsigned long i = 0; i < ci->token_cnt; i++)
+    bool scope_available = false;
+    for(unsigned long i = 0; i < lexed_cnt; i++)
     {
-        if(ci->token[i].subtoken_cnt < 2)
-        {
-            // Label Check
-            size_t size = strlen(ci->token[i].subtoken[0]);
+        compiler_token_t token = lexed[i];
+        compiler_slice_t *st0 = code_token_subtoken(ci, &token, 0);
 
+        if(token.subtoken_cnt < 2)
+        {
             // Check if the last character of the first subtoken is a ':'
-            if(ci->token[i].subtoken[0][size - 1] == ':')
+            if(st0->str[st0->len - 1] == ':')
             {
                 section_mode = 0b0;
 
                 // Its a scoped label if its first character is a dot
-                static bool scope_available = false;
-                if(ci->token[i].subtoken[0][0] == '_')
+                if(st0->str[0] == '_')
                 {
                     scope_available = true;
-                    ci->token[i].type = COMPILER_TOKEN_TYPE_LABEL;
+                    token.type = COMPILER_TOKEN_TYPE_LABEL;
                 }
-                else if(ci->token[i].subtoken[0][0] == '.')
+                else if(st0->str[0] == '.')
                 {
                     if(!scope_available)
                     {
-                        printf("[*] no scope defined for scoped label \"%s\"\n", ci->token[i].subtoken[0]);
-                        exit(1);
+                        compiler_error(ci, "no scope defined for scoped label \"%.*s\"", (int)st0->len, st0->str);
                     }
 
-                    ci->token[i].type = COMPILER_TOKEN_TYPE_LABEL_SCOPED;
+                    token.type = COMPILER_TOKEN_TYPE_LABEL_SCOPED;
                 }
                 else
                 {
-                    printf("[!] \"%s\" is not a legal label definition \n", ci->token[i].token);
-                    exit(1);
+                    compiler_error(ci, "\"%.*s\" is not a legal label definition", (int)token.token.len, token.token.str);
                 }
 
-                ci->token[i].addr = addr;
+                token.addr = addr;
+                *code_token_push(ci) = token;
                 continue;
             }
         }
-        else if(ci->token[i].subtoken_cnt < 3)
+        else if(token.subtoken_cnt < 3)
         {
-            if(strcmp(ci->token[i].subtoken[0], "section") == 0)
+            if(code_slice_equal(st0, "section"))
             {
                 section_mode = 0b1;
-                ci->token[i].type = COMPILER_TOKEN_TYPE_SECTION;
-                ci->token[i].addr = 0x0;
+                token.type = COMPILER_TOKEN_TYPE_SECTION;
+                token.addr = 0x0;
+                *code_token_push(ci) = token;
                 continue;
             }
         }
-        else if(ci->token[i].subtoken_cnt < 4)
+        else if(token.subtoken_cnt < 4)
         {
-            if(strcmp(ci->token[i].subtoken[0], "const") == 0)
+            if(code_slice_equal(st0, "const"))
             {
-                ci->token[i].type = COMPILER_TOKEN_TYPE_CONSTANT;
-                ci->token[i].addr = 0x0;
+                token.type = COMPILER_TOKEN_TYPE_CONSTANT;
+                token.addr = 0x0;
+                *code_token_push(ci) = token;
                 continue;
             }
         }
@@ -373,232 +492,54 @@ void code_tokengen(compiler_invocation_t *ci)
         if(section_mode)
         {
             // Its part of a section
-            ci->token[i].type = COMPILER_TOKEN_TYPE_SECTION_DATA;
-            ci->token[i].addr = 0x0;
+            token.type = COMPILER_TOKEN_TYPE_SECTION_DATA;
+            token.addr = 0x0;
+            *code_token_push(ci) = token;
+        }
+        else if(token.subtoken_cnt >= 2 && code_slice_equal(st0, "call"))
+        {
+            // Its a call, the subtokens of the call stay where the lexer put them
+            code_tokengen_call(ci, &token, &ci->subtoken[token.subtoken], &addr);
         }
         else
         {
-            // Its probably ASM
-            // Before blindly assuming it we check if its a call
-            if(ci->token[i].subtoken_cnt >= 2 &&
-               strcmp(ci->token[i].subtoken[0], "call") == 0)
-            {
-                unsigned char needed_cycleops = ci->token[i].subtoken_cnt - 2;
-    
-                // Extract all subtokens without delimiter
-                char **subtoken = calloc(ci->token[i].subtoken_cnt, sizeof(char*));
-
-                for(unsigned long a = 0; a < ci->token[i].subtoken_cnt; a++)
-                {
-                    size_t subtoken_len = strlen(ci->token[i].subtoken[a]);
-                    subtoken[a] = malloc(subtoken_len + 1);
-                    memcpy(subtoken[a], ci->token[i].subtoken[a], subtoken_len + 1);
-                    if(subtoken_len > 0 && subtoken[a][subtoken_len - 1] == ',')
-                    {
-                        subtoken[a][subtoken_len - 1] = '\0';
-                    }
-                }
-
-                #define PUSH_MAX 7
-
-                const char *push_map[PUSH_MAX] = {
-                    "r0", "r1", "r2", "r3", "r4", "r5", "r6"
-                };
-
-                // Check max args
-                if(needed_cycleops > PUSH_MAX)
-                {
-                    printf("[!] call can have maximum of %d arguments!\n", PUSH_MAX);
-                    exit(EXIT_FAILURE);
-                }
-
-                // Determine which registers actually need action
-                bool needs_action[PUSH_MAX] = {false};
-                unsigned char action_count = 0;
-
-                for(unsigned char arg = 0; arg < needed_cycleops; arg++)
-                {
-                    // If argument is already in the target register, skip it
-                    if(strcmp(push_map[arg], subtoken[2 + arg]) != 0)
-                    {
-                        needs_action[arg] = true;
-                        action_count++;
-                    }
-                }
-
-                // Check for conflicts: is any source register going to be clobbered?
-                // Example: call _func, r1, r0  → mov r0, r1; mov r1, r0 (r0 clobbered before read!)
-                bool has_conflict = false;
-                for(unsigned char arg = 0; arg < needed_cycleops && !has_conflict; arg++)
-                {
-                    if(!needs_action[arg]) continue;
-        
-                    const char *source = subtoken[2 + arg];
-        
-                    // Check if this source is a target register that will be overwritten
-                    // by an EARLIER mov (lower index)
-                    for(unsigned char earlier = 0; earlier < arg; earlier++)
-                    {
-                        if(needs_action[earlier] && strcmp(source, push_map[earlier]) == 0)
-                        {
-                            has_conflict = true;
-                            break;
-                        }
-                    }
-                }
-
-                // If conflict detected, fall back to saving ALL argument registers
-                if(has_conflict)
-                {
-                    for(unsigned char arg = 0; arg < needed_cycleops; arg++)
-                    {
-                        needs_action[arg] = true;
-                    }
-                    action_count = needed_cycleops;
-                }
-
-                // Calculate token count
-                // push for each action + mov for each action + 1 bl + pop for each action
-                unsigned char needed_tokens = (action_count * 3) + 1;
-    
-                // Edge case: no actions needed, just the bl
-                if(action_count == 0)
-                {
-                    needed_tokens = 1;
-                }
-
-                unsigned char token_idx = 0;
-                compiler_token_t *tci = calloc(needed_tokens, sizeof(compiler_token_t));
-
-                // Injecting pushes (only for registers that need it)
-                for(unsigned char push = 0; push < needed_cycleops; push++)
-                {
-                    if(!needs_action[push]) continue;
-        
-                    const char *reg = push_map[push];
-                    tci[token_idx].type = COMPILER_TOKEN_TYPE_ASM;
-                    tci[token_idx].addr = addr;
-                    tci[token_idx].token = malloc(strlen(reg) + 6);
-                    sprintf(tci[token_idx].token, "push %s", reg);
-                    tci[token_idx].subtoken_cnt = 2;
-                    tci[token_idx].subtoken = calloc(2, sizeof(char*));
-                    tci[token_idx].subtoken[0] = strdup("push");
-                    tci[token_idx].subtoken[1] = strdup(reg);
-                    addr += 4;
-                    token_idx++;
-                }
-
-                // Injecting moves (only for registers that need it)
-                for(unsigned char mov = 0; mov < needed_cycleops; mov++)
-                {
-                    if(!needs_action[mov]) continue;
-        
-                    const char *dest_reg = push_map[mov];
-                    const char *source = subtoken[2 + mov];
-                    tci[token_idx].type = COMPILER_TOKEN_TYPE_ASM;
-                    tci[token_idx].addr = addr;
-                    tci[token_idx].token = malloc(strlen(dest_reg) + strlen(source) + 7);
-                    sprintf(tci[token_idx].token, "mov %s, %s", dest_reg, source);
-                    tci[token_idx].subtoken_cnt = 3;
-                    tci[token_idx].subtoken = calloc(3, sizeof(char*));
-                    tci[token_idx].subtoken[0] = strdup("mov");
-                    tci[token_idx].subtoken[1] = strdup(dest_reg);
-                    tci[token_idx].subtoken[2] = strdup(source);
-                    addr += 4;
-                    token_idx++;
-                }
-
-                // Injecting branch link
-                size_t call_name_len = strlen(subtoken[1]);
-                tci[token_idx].type = COMPILER_TOKEN_TYPE_ASM;
-                tci[token_idx].addr = addr;
-                tci[token_idx].token = malloc(4 + call_name_len);
-                sprintf(tci[token_idx].token, "bl %s", subtoken[1]);
-                tci[token_idx].subtoken_cnt = 2;
-                tci[token_idx].subtoken = calloc(2, sizeof(char*));
-                tci[token_idx].subtoken[0] = strdup("bl");
-                tci[token_idx].subtoken[1] = strdup(subtoken[1]);
-                addr += 4;
-                token_idx++;
-
-                // Injecting pops (reverse order)
-                for(unsigned char pop = 0; pop < needed_cycleops; pop++)
-                {
-                    unsigned char pop_idx = needed_cycleops - 1 - pop;
-                    if(!needs_action[pop_idx]) continue;
-        
-                    const char *reg = push_map[pop_idx];
-                    tci[token_idx].type = COMPILER_TOKEN_TYPE_ASM;
-                    tci[token_idx].addr = addr;
-                    tci[token_idx].token = malloc(strlen(reg) + 5);
-                    sprintf(tci[token_idx].token, "pop %s", reg);
-                    tci[token_idx].subtoken_cnt = 2;
-                    tci[token_idx].subtoken = calloc(2, sizeof(char*));
-                    tci[token_idx].subtoken[0] = strdup("pop");
-                    tci[token_idx].subtoken[1] = strdup(reg);
-                    addr += 4;
-                    token_idx++;
-                }
-
-                /* Injecting tci into tokens */
-                // Free the original call token's data
-                free(ci->token[i].token);
-                for(unsigned long st = 0; st < ci->token[i].subtoken_cnt; st++)
-                {
-                    free(ci->token[i].subtoken[st]);
-                }
-                free(ci->token[i].subtoken);
-
-                // Calculate new token count: remove 1 (the call), add needed_tokens
-                size_t new_token_cnt = ci->token_cnt - 1 + needed_tokens;
-
-                // Allocate new token array
-                compiler_token_t *new_tokens = calloc(new_token_cnt, sizeof(compiler_token_t));
-
-                // Copy tokens before the call instruction
-                if(i > 0)
-                {
-                    memcpy(new_tokens, ci->token, i * sizeof(compiler_token_t));
-                }
-
-                // Copy the expanded tci tokens
-                memcpy(&new_tokens[i], tci, needed_tokens * sizeof(compiler_token_t));
-
-                // Copy tokens after the call instruction
-                if(i + 1 < ci->token_cnt)
-                {
-                    memcpy(&new_tokens[i + needed_tokens], 
-                           &ci->token[i + 1], 
-                           (ci->token_cnt - i - 1) * sizeof(compiler_token_t));
-                }
-
-                // Free old token array and tci (but not tci contents, they're now in new_tokens)
-                free(ci->token);
-                free(tci);
+            // Its ASM
+            token.type = COMPILER_TOKEN_TYPE_ASM;
+            token.addr = addr;
+            addr += 4;
+            *code_token_push(ci) = token;
+        }
+    }
+}
 
-                // Free subtoken copies
-                for(unsigned long a = 0; a < ci->token[i].subtoken_cnt; a++)
-                {
-                    free(subtoken[a]);
-                }
-                free(subtoken);
+void code_image_reserve(compiler_invocation_t *ci,
+                        unsigned long size)
+{
+    /* addresses are 16 bit, anything past that can never be loaded */
+    if(size > COMPILER_IMAGE_MAX)
+    {
+        compiler_error(ci, "image exceeds %d bytes, %lu bytes needed", COMPILER_IMAGE_MAX, size);
+    }
 
-                // Update ci
-                ci->token = new_tokens;
-                ci->token_cnt = new_token_cnt;
+    if(size <= ci->image_cap)
+    {
+        return;
+    }
 
-                // Adjust loop counter: we replaced 1 token with needed_tokens,
-                // so skip past the injected tokens (minus 1 because loop will increment)
-                i += needed_tokens - 1;
-            }
-            else
-            {
-                ci->token[i].type = COMPILER_TOKEN_TYPE_ASM;
-                ci->token[i].addr = addr;
-                addr += 4;
-            }
-        }
+    /* doubling the image buffer, fresh bytes are zeroed so reserved space reads as zero */
+    unsigned long cap = (ci->image_cap == 0) ? 256 : ci->image_cap;
+    while(cap < size)
+    {
+        cap *= 2;
+    }
+    if(cap > COMPILER_IMAGE_MAX)
+    {
+        cap = COMPILER_IMAGE_MAX;
     }
+
+    ci->image = compiler_arena_realloc(&ci->arena, ci->image, ci->image_cap, cap);
+    memset(ci->image + ci->image_cap, 0, cap - ci->image_cap);
+    ci->image_cap = cap;
 }
 
 void code_binary_spitout(compiler_invocation_t *ci)
@@ -613,7 +554,9 @@ void code_binary_spitout(compiler_invocation_t *ci)
     close(fd);
 }
 
-char *code_token_bind(compiler_token_t *ct, unsigned char at_i)
+char *code_token_bind(compiler_invocation_t *ci,
+                      compiler_token_t *ct,
+                      unsigned char at_i)
 {
     /* null pointer check */
     if(ct == NULL || ct->subtoken_cnt < at_i)
@@ -622,23 +565,23 @@ char *code_token_bind(compiler_token_t *ct, unsigned char at_i)
     }
 
     /* getting size */
-    unsigned short size = 0;
-    for(unsigned char i = at_i; i < ct->subtoken_cnt; i++)
+    size_t size = 0;
+    for(unsigned long i = at_i; i < ct->subtoken_cnt; i++)
     {
-        size += strlen(ct->subtoken[i]);
+        size += code_token_subtoken(ci, ct, i)->len;
     }
 
     /* now try to alloc */
-    char *name = calloc(1, size);
+    char *name = compiler_arena_calloc(&ci->arena, 1, size + 1);
     char *ptr = name;
 
     /* doing shit */
-    for(unsigned char i = at_i; i < ct->subtoken_cnt; i++)
+    for(unsigned long i = at_i; i < ct->subtoken_cnt; i++)
     {
-        size_t size = strlen(ct->subtoken[i]);
-        memcpy(ptr, ct->subtoken[i], size);
-        ptr += size;
+        compiler_slice_t *st = code_token_subtoken(ci, ct, i);
+        memcpy(ptr, st->str, st->len);
+        ptr += st->len;
     }
 
     return name;
-}
\ No newline at end of file
+}
@@ -28,12 +28,24 @@
 #include <stdlib.h>
 #include <compiler/type.h>
 
+#include <stdbool.h>
+
+static inline compiler_slice_t *code_token_subtoken(compiler_invocation_t *ci,
+                                                   compiler_token_t *ct,
+                                                   unsigned long at_i)
+{
+    return &ci->subtoken[ct->subtoken + at_i];
+}
+
+bool code_slice_equal(const compiler_slice_t *slice, const char *str);
+char *code_slice_copy(compiler_invocation_t *ci, const compiler_slice_t *slice, char *buf, size_t size);
+
 void get_code_buffer(char **files, int file_cnt, compiler_invocation_t *ci);
-void code_remove_comments(compiler_invocation_t *ci);
-void code_remove_newlines(compiler_invocation_t *ci);
-void code_replace_tab_with_spaces(compiler_invocation_t *ci);
+void get_code_buffer_memory(const char *src, size_t len, compiler_invocation_t *ci);
 void code_tokengen(compiler_invocation_t *ci);
+void code_subtoken_push(compiler_invocation_t *ci, compiler_token_t *ct, const char *str, unsigned long len);
 void code_binary_spitout(compiler_invocation_t *ci);
-char *code_token_bind(compiler_token_t *ct, unsigned char at_i);
+void code_image_reserve(compiler_invocation_t *ci, unsigned long size);
+char *code_token_bind(compiler_invocation_t *ci, compiler_token_t *ct, unsigned char at_i);
 
 #endif /* COMPILER_CODE_H */
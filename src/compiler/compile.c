@@ -24,77 +24,247 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
 #include <compiler/compile.h>
+#include <compiler/error.h>
 #include <compiler/code.h>
 #include <compiler/label.h>
 #include <compiler/section.h>
 #include <compiler/constant.h>
 #include <compiler/compiler.h>
+#include <compiler/object.h>
+#include <compiler/link.h>
+#include <compiler/parallel.h>
+#include <compiler/cache.h>
+#include <compiler/peephole.h>
+#include <compiler/frame.h>
 
 compiler_invocation_t *compiler_invocation_alloc(void)
 {
     compiler_invocation_t *ci = calloc(1, sizeof(compiler_invocation_t));
+    compiler_arena_init(&ci->arena);
+    code_image_reserve(ci, 4);
     ci->image_uaddr += 4;   /* image has to stay alligned ;w; */
     return ci;
 }
 
 void compiler_invocation_dealloc(compiler_invocation_t *ci)
 {
-    /* freeing the code it self */
-    free(ci->code);
+    /* everything the invocation allocated lives in its arena */
+    compiler_arena_release(&ci->arena);
+    free(ci);
+}
 
-    /* freeing the token structures */
-    for(unsigned long i = 0; i < ci->token_cnt; i++)
+static void compiler_invocation_assemble(compiler_invocation_t *ci)
+{
+    /* generating tokens,labels,sections out of the code */
+    code_tokengen(ci);
+    code_token_frame(ci);
+    if(ci->optimize)
     {
-        free(ci->token[i].token);
-        for(unsigned long a = 0; a < ci->token[i].subtoken_cnt; i++)
+        code_token_peephole(ci);
+    }
+    code_token_label(ci);
+    code_token_section(ci);
+
+    /* relocatable output leaves the entry point to the linker and exports its labels */
+    if(ci->object != NULL)
+    {
+        object_export_labels(ci);
+    }
+    else
+    {
+        code_token_label_insert_start(ci);
+    }
+
+    code_token_constant(ci);
+
+    /* finally compiling it to machine code */
+    la16_compiler_lowlevel(ci);
+}
+
+typedef struct {
+    char **files;
+    compiler_invocation_t **unit;           /* one invocation per file */
+    bool write;                             /* writing each object next to its file */
+    bool optimize;                          /* running the peephole pass on every file */
+    const char *cache;                      /* object cache directory, NULL if disabled */
+} compile_ctx_t;
+
+static void compile_unit(void *arg,
+                         unsigned long i)
+{
+    compile_ctx_t *ctx = arg;
+
+    /* every file is assembled on its own, data starts at the beginning of the object */
+    compiler_invocation_t *ci = compiler_invocation_alloc();
+    ctx->unit[i] = ci;
+    ci->object = compiler_arena_calloc(&ci->arena, 1, sizeof(compiler_object_t));
+    ci->image_uaddr = 0;
+    ci->optimize = ctx->optimize;
+
+    get_code_buffer(&ctx->files[i], 1, ci);
+
+    /* unchanged sources come straight out of the cache */
+    if(ctx->cache == NULL)
+    {
+        compiler_invocation_assemble(ci);
+    }
+    else
+    {
+        char *path = cache_path(ci, ctx->cache);
+        if(!cache_load(ci, path))
         {
-            free(ci->token[i].subtoken[a]);
+            compiler_invocation_assemble(ci);
+            cache_store(ci, path);
         }
-        free(ci->token[i].subtoken);
     }
-    free(ci->token);
 
-    /* freeing labels */
-    for(unsigned long i = 0; i < ci->label_cnt; i++)
+    if(ctx->write)
     {
-        free(ci->label[i].name);
+        object_write(ci, object_path(ci, ctx->files[i]));
     }
-    free(ci->label);
+}
 
-    free(ci);
+static void compile_units(compiler_invocation_t *ci,
+                          compile_ctx_t *ctx,
+                          int file_cnt)
+{
+    /* files are independent till link time, so they are assembled in parallel */
+    ctx->unit = compiler_arena_calloc(&ci->arena, file_cnt, sizeof(compiler_invocation_t*));
+    ctx->cache = cache_dir(ci);
+    compiler_parallel_for(ci, file_cnt, compile_unit, ctx);
+}
+
+static void compile_units_dealloc(compile_ctx_t *ctx,
+                                  int file_cnt)
+{
+    for(int i = 0; i < file_cnt; i++)
+    {
+        compiler_invocation_dealloc(ctx->unit[i]);
+    }
 }
 
 void compile_files(char **files,
-                   int file_cnt)
+                   int file_cnt,
+                   bool optimize)
 {
-    /* allocating compiler invocation */
+    /* allocating compiler invocation for the image */
     compiler_invocation_t *ci = compiler_invocation_alloc();
 
-    /* gathering code */
-    get_code_buffer(files, file_cnt, ci);
+    /* assembling every file into an object, errors exit the process */
+    compile_ctx_t ctx = {
+        .files = files,
+        .write = false,
+        .optimize = optimize,
+    };
+    compile_units(ci, &ctx, file_cnt);
 
-    /* formatting code by removing all the useless
-     * and ignored stuff and extracting solely usable
-     * information to process
-     */
-    code_remove_comments(ci);
-    code_replace_tab_with_spaces(ci);
-    code_remove_newlines(ci);
+    /* linking the objects straight out of memory */
+    compiler_object_t *object = compiler_arena_calloc(&ci->arena, file_cnt, sizeof(compiler_object_t));
+    for(int i = 0; i < file_cnt; i++)
+    {
+        object[i] = *ctx.unit[i]->object;
+    }
+    link_objects(ci, object, file_cnt);
 
-    /* generating tokens,labels,sections out of the code */
-    code_tokengen(ci);
-    code_token_label(ci);
-    code_token_section(ci);
-    code_token_label_insert_start(ci);
-    code_token_constant(ci);
+    /* spitting out binary */
+    code_binary_spitout(ci);
 
-    /* finally compiling it to machine code */
-    la16_compiler_lowlevel(ci);
+    /* deallocating compiler invocations */
+    compile_units_dealloc(&ctx, file_cnt);
+    compiler_invocation_dealloc(ci);
+}
+
+void compile_objects(char **files,
+                     int file_cnt,
+                     bool optimize)
+{
+    compiler_invocation_t *ci = compiler_invocation_alloc();
+
+    /* assembling every file into an object file next to it */
+    compile_ctx_t ctx = {
+        .files = files,
+        .write = true,
+        .optimize = optimize,
+    };
+    compile_units(ci, &ctx, file_cnt);
+
+    compile_units_dealloc(&ctx, file_cnt);
+    compiler_invocation_dealloc(ci);
+}
+
+void link_files(char **files,
+                int file_cnt)
+{
+    /* allocating compiler invocation for the image */
+    compiler_invocation_t *ci = compiler_invocation_alloc();
+
+    /* reading all objects in */
+    compiler_object_t *object = compiler_arena_calloc(&ci->arena, file_cnt, sizeof(compiler_object_t));
+    for(int i = 0; i < file_cnt; i++)
+    {
+        object_read(ci, files[i], &object[i]);
+    }
+
+    /* linking them into the boot image */
+    link_objects(ci, object, file_cnt);
 
     /* spitting out binary */
     code_binary_spitout(ci);
 
     /* deallocating compiler invocation */
-    //compiler_invocation_dealloc(ci);
+    compiler_invocation_dealloc(ci);
+}
+
+bool la16_assemble(const char *src,
+                   size_t len,
+                   la16_image_t *out,
+                   la16_diag_t *diag)
+{
+    jmp_buf fail;
+
+    out->data = NULL;
+    out->size = 0;
+
+    if(diag != NULL)
+    {
+        diag->error = 0;
+        diag->message[0] = '\0';
+    }
+
+    /* allocating compiler invocation, errors unwind back to here */
+    compiler_invocation_t *ci = compiler_invocation_alloc();
+    ci->fail = &fail;
+    ci->diag = diag;
+
+    if(setjmp(fail) != 0)
+    {
+        compiler_invocation_dealloc(ci);
+        return false;
+    }
+
+    /* assembling straight out of the callers buffer */
+    get_code_buffer_memory(src, len, ci);
+    compiler_invocation_assemble(ci);
+
+    /* handing a copy of the image to the caller, the arena dies with the invocation */
+    out->data = malloc(ci->image_uaddr);
+    if(out->data == NULL)
+    {
+        compiler_error(ci, "out of memory");
+    }
+    memcpy(out->data, ci->image, ci->image_uaddr);
+    out->size = ci->image_uaddr;
+
+    compiler_invocation_dealloc(ci);
+    return true;
+}
+
+void la16_image_release(la16_image_t *image)
+{
+    free(image->data);
+    image->data = NULL;
+    image->size = 0;
 }
@@ -25,8 +25,20 @@
 #ifndef COMPILER_COMPILE_H
 #define COMPILER_COMPILE_H
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <compiler/type.h>
+#include <compiler/diag.h>
 
-void compile_files(char **files, int file_cnt);
+typedef struct {
+    unsigned char *data;                    /* boot image, owned by the caller */
+    size_t size;                            /* size of the boot image in bytes */
+} la16_image_t;
+
+void compile_files(char **files, int file_cnt, bool optimize);
+void compile_objects(char **files, int file_cnt, bool optimize);
+void link_files(char **files, int file_cnt);
+bool la16_assemble(const char *src, size_t len, la16_image_t *out, la16_diag_t *diag);
+void la16_image_release(la16_image_t *image);
 
 #endif /* COMPILER_COMPILE_H */
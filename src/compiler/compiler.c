@@ -30,6 +30,12 @@
 #include <compiler/parse.h>
 #include <compiler/opcode.h>
 #include <compiler/register.h>
+#include <compiler/symtab.h>
+#include <compiler/code.h>
+#include <compiler/label.h>
+#include <compiler/error.h>
+#include <compiler/object.h>
+#include <compiler/parallel.h>
 
 #include <coder/bitwalker.h>
 
@@ -64,7 +70,8 @@ unsigned char la16_mode_create_from_codings(unsigned char a, unsigned char b)
     }
 }
 
-unsigned int la16_compiler_machinecode(la16_compiler_instruction_t *cinstr)
+unsigned int la16_compiler_machinecode(compiler_invocation_t *ci,
+                                       la16_compiler_instruction_t *cinstr)
 {
     /* prepare bitwalker */
     unsigned int instruction = 0;
@@ -77,6 +84,14 @@ unsigned int la16_compiler_machinecode(la16_compiler_instruction_t *cinstr)
     /* inserting mode */
     bitwalker_write(&bw, cinstr->mode, 3);
 
+    /* only register register instructions have room for a memory operand */
+    if(cinstr->ext != 0 &&
+       cinstr->mode != LA16_PARAMETER_CODING_COMBINATION_REG_REG &&
+       cinstr->mode != LA16_PARAMETER_CODING_COMBINATION_IMM8_IMM8)
+    {
+        compiler_error(ci, "memory operand needs registers on both sides");
+    }
+
     /* now here we go */
     switch(cinstr->mode)
     {
@@ -85,19 +100,18 @@ unsigned int la16_compiler_machinecode(la16_compiler_instruction_t *cinstr)
         case LA16_PARAMETER_CODING_COMBINATION_REG:
             if(cinstr->arg[0] > 0b00011111)
             {
-                printf("[!] illegal register\n");
-                exit(1);
+                compiler_error(ci, "illegal register");
             }
             bitwalker_write(&bw, cinstr->arg[0], 5);
             break;
         case LA16_PARAMETER_CODING_COMBINATION_REG_REG:
             if(cinstr->arg[0] > 0b00011111 || cinstr->arg[1] > 0b00011111)
             {
-                printf("[!] illegal register\n");
-                exit(1);
+                compiler_error(ci, "illegal register");
             }
             bitwalker_write(&bw, cinstr->arg[0], 5);
             bitwalker_write(&bw, cinstr->arg[1], 5);
+            bitwalker_write(&bw, cinstr->ext, LA16_MEMORY_OPERAND_BITS);
             break;
         case LA16_PARAMETER_CODING_COMBINATION_IMM16:
             bitwalker_write(&bw, cinstr->arg[0], 16);
@@ -105,8 +119,7 @@ unsigned int la16_compiler_machinecode(la16_compiler_instruction_t *cinstr)
         case LA16_PARAMETER_CODING_COMBINATION_IMM16_REG:
             if(cinstr->arg[1] > 0b00011111)
             {
-                printf("[!] illegal register\n");
-                exit(1);
+                compiler_error(ci, "illegal register");
             }
             bitwalker_write(&bw, cinstr->arg[0], 16);
             bitwalker_write(&bw, cinstr->arg[1], 5);
@@ -114,8 +127,7 @@ unsigned int la16_compiler_machinecode(la16_compiler_instruction_t *cinstr)
         case LA16_PARAMETER_CODING_COMBINATION_REG_IMM16:
             if(cinstr->arg[0] > 0b00011111)
             {
-                printf("[!] illegal register\n");
-                exit(1);
+                compiler_error(ci, "illegal register");
             }
             bitwalker_write(&bw, cinstr->arg[0], 5);
             bitwalker_write(&bw, cinstr->arg[1], 16);
@@ -123,24 +135,37 @@ unsigned int la16_compiler_machinecode(la16_compiler_instruction_t *cinstr)
         case LA16_PARAMETER_CODING_COMBINATION_IMM8_IMM8:
             if(cinstr->arg[0] > 0b11111111 || cinstr->arg[1] > 0b11111111)
             {
-                printf("[!] illegal 8bit intermediate\n");
-                exit(1);
+                compiler_error(ci, "illegal 8bit intermediate");
+            }
+            if(cinstr->ext > 0b00011111)
+            {
+                compiler_error(ci, "illegal register");
             }
             bitwalker_write(&bw, cinstr->arg[0], 8);
             bitwalker_write(&bw, cinstr->arg[1], 8);
+            bitwalker_write(&bw, cinstr->ext, 5);
+            break;
+        case LA16_PARAMETER_CODING_COMBINATION_IMM16_IMM5:
+            if(cinstr->arg[1] > 0b00011111)
+            {
+                compiler_error(ci, "illegal 5bit intermediate");
+            }
+            bitwalker_write(&bw, cinstr->arg[0], 16);
+            bitwalker_write(&bw, cinstr->arg[1], 5);
             break;
         default:
-            printf("[!] illegal mode: 0x%x\n", cinstr->mode);
-            exit(1);
+            compiler_error(ci, "illegal mode: 0x%x", cinstr->mode);
     }
 
     return instruction;
 }
 
 void la16_compiler_lowcodeline_parameter_parser(const char *parameter,
-                                                const char *scope,
+                                                const compiler_scope_t *scope,
                                                 unsigned char *ptcrypt,
                                                 unsigned short *value,
+                                                compiler_object_reloc_t *reloc,
+                                                compiler_arena_t *arena,
                                                 compiler_invocation_t *ci)
 {
     *ptcrypt = LA16_CODING_ERR;
@@ -162,13 +187,20 @@ void la16_compiler_lowcodeline_parameter_parser(const char *parameter,
     }
 
     /* checking if parameter is certain type */
-    parse_type_return_t pr = parse_type_lc(parameter);
+    parse_type_return_t pr = parse_type_lc(parameter, arena);
     if(pr.type != PARSE_TYPE_STRING)
     {
         /* must be intermediate */
         *ptcrypt = LA16_CODING_IMM;
         *value   = pr.value;
     }
+    else if(ci->object != NULL)
+    {
+        /* relocatable output leaves the address to the linker */
+        object_reloc_reference(ci, arena, parameter, scope, reloc);
+        *ptcrypt = LA16_CODING_IMM;
+        *value   = 0;
+    }
     else
     {
         /* checking if its a label */
@@ -184,8 +216,7 @@ void la16_compiler_lowcodeline_parameter_parser(const char *parameter,
             unsigned int const_value = code_token_constant_lookup(ci, parameter);
             if(const_value == COMPILER_CONSTANT_NOT_FOUND)
             {
-                printf("[!] lookup: %s doesnt exist\n", parameter);
-                exit(1);
+                compiler_error(ci, "lookup: %s doesnt exist", parameter);
             }
             *ptcrypt = LA16_CODING_IMM;
             *value   = const_value;
@@ -193,79 +224,222 @@ void la16_compiler_lowcodeline_parameter_parser(const char *parameter,
     }
 }
 
-unsigned int la16_compiler_lowcodeline(const char *code_line, const char *scope, compiler_invocation_t *ci)
+/*
+ * rewrites a [reg], [reg+imm], [reg-imm] or [reg]+ parameter into
+ * its address register and returns the memory bits of the instruction
+ */
+static unsigned short la16_compiler_memory_operand(char *parameter,
+                                                   compiler_invocation_t *ci)
+{
+    size_t len = strlen(parameter);
+    char *close = strchr(parameter, ']');
+    if(close == NULL)
+    {
+        compiler_error(ci, "memory operand %s is not closed", parameter);
+    }
+
+    unsigned short memory = 0;
+    if(close[1] == '+' && close[2] == '\0')
+    {
+        memory |= LA16_MEMORY_POSTINC;
+    }
+    else if(close[1] != '\0')
+    {
+        compiler_error(ci, "illegal memory operand: %s", parameter);
+    }
+    *close = '\0';
+
+    // Splitting the displacement off the address register
+    char *sign = strpbrk(parameter + 1, "+-");
+    long disp = 0;
+    if(sign != NULL)
+    {
+        char *end = NULL;
+        disp = strtol(sign + 1, &end, 0);
+        if(end == sign + 1 || *end != '\0')
+        {
+            compiler_error(ci, "displacement of memory operand has to be a number");
+        }
+        if(*sign == '-')
+        {
+            disp = -disp;
+        }
+        *sign = '\0';
+
+        if(disp < LA16_MEMORY_DISP_MIN || disp > LA16_MEMORY_DISP_MAX)
+        {
+            compiler_error(ci, "displacement %ld out of range", disp);
+        }
+        if(memory & LA16_MEMORY_POSTINC)
+        {
+            compiler_error(ci, "post incremented memory operand cannot have a displacement");
+        }
+    }
+    memory |= (unsigned short)disp & LA16_MEMORY_DISP_MASK;
+
+    if(register_from_string(parameter + 1) == NULL)
+    {
+        compiler_error(ci, "memory operand needs an address register");
+    }
+    memmove(parameter, parameter + 1, len);
+    return memory;
+}
+
+/*
+ * branches are relative to the instruction, so their target has to be
+ * code of the same file, the register of an immediate compare moves
+ * behind both immediates to make room for the offset
+ */
+static void la16_compiler_branch(compiler_token_t *ct,
+                                 const compiler_scope_t *scope,
+                                 const char *target,
+                                 la16_compiler_instruction_t *cinstr,
+                                 compiler_invocation_t *ci)
+{
+    const compiler_label_t *label = label_lookup_label(ci, target, scope);
+    if(label == NULL || !label->rel)
+    {
+        compiler_error(ci, "branch target %s has to be a code label of the same file", target);
+    }
+
+    long offset = ((long)label->addr - (long)ct->addr) / 4;
+
+    if(cinstr->mode == LA16_PARAMETER_CODING_COMBINATION_REG_REG)
+    {
+        if(offset < LA16_BRANCH_OFFSET_MIN || offset > LA16_BRANCH_OFFSET_MAX)
+        {
+            compiler_error(ci, "branch target %s out of range", target);
+        }
+        cinstr->ext = (unsigned short)offset & LA16_MEMORY_DISP_MASK;
+    }
+    else if(cinstr->mode == LA16_PARAMETER_CODING_COMBINATION_REG_IMM16)
+    {
+        if(offset < LA16_BRANCH_OFFSET8_MIN || offset > LA16_BRANCH_OFFSET8_MAX)
+        {
+            compiler_error(ci, "branch target %s out of range", target);
+        }
+        cinstr->mode = LA16_PARAMETER_CODING_COMBINATION_IMM8_IMM8;
+        cinstr->ext = cinstr->arg[0];
+        cinstr->arg[0] = (unsigned short)offset & 0xFF;
+    }
+    else
+    {
+        compiler_error(ci, "branches compare a register with a register or an 8bit intermediate");
+    }
+}
+
+/* the byte count register of a block instruction goes into the displacement bits */
+static void la16_compiler_block(const char *length,
+                                la16_compiler_instruction_t *cinstr,
+                                compiler_invocation_t *ci)
+{
+    register_entry_t *reg = register_from_string(length);
+    if(reg == NULL || cinstr->mode != LA16_PARAMETER_CODING_COMBINATION_REG_REG)
+    {
+        compiler_error(ci, "block instructions take three registers");
+    }
+    cinstr->ext = reg->reg & LA16_BLOCK_REG_MASK;
+}
+
+la16_compiler_instruction_t la16_compiler_lowcodeline_instruction(compiler_token_t *ct,
+                                                                   const compiler_scope_t *scope,
+                                                                   compiler_object_reloc_t *reloc,
+                                                                   compiler_arena_t *arena,
+                                                                   compiler_invocation_t *ci)
 {
     char space = ' ';
     char pspace = ',';
-    char nterm = '\0';
 
     char opcode_string[20] = {};
-    char parameter_string[2][512] = {};
+    char parameter_string[3][512] = {};
 
     unsigned char mode = LA16_PARAMETER_CODING_COMBINATION_NONE;
     unsigned char ptc[2] = {};
     unsigned short pv[2] = {};
 
-    size_t len = strlen(code_line);
-    size_t i = 0;
-
-    // Opcode pass
-    for(size_t off = i; i < len; i++)
-    {
-        if(code_line[i] == space)
-        {
-            i++;
-            break;
-        }
-        opcode_string[i - off] = code_line[i];
-    }
+    // Opcode pass, the opcode is always the first subtoken
+    code_slice_copy(ci, code_token_subtoken(ci, ct, 0), opcode_string, sizeof(opcode_string));
 
     opcode_entry_t *opcode = opcode_from_string(opcode_string);
 
     if(opcode == NULL)
     {
-        printf("[!] illegal opcode: %s\n", opcode_string);
-        exit(1);
+        compiler_error(ci, "illegal opcode: %s", opcode_string);
     }
 
-    // Now Find out the parameters
-    for(size_t param = 0; param < 2 && i < len; param++)
+    // Now Find out the parameters, they are spread over the remaining subtokens
+    size_t param = 0;
+    size_t off = 0;
+    for(unsigned long st = 1; st < ct->subtoken_cnt && param < 3; st++)
     {
-        for(size_t off = 0; i < len; i++)
+        compiler_slice_t *slice = code_token_subtoken(ci, ct, st);
+        for(unsigned long i = 0; i < slice->len && param < 3; i++)
         {
             // Handle codeline special cases
-            if(code_line[i] == space)
+            if(slice->str[i] == space)
             {
                 continue;
             }
-            else if(code_line[i] == pspace)
+            else if(slice->str[i] == pspace)
             {
-                i++;
-                break;
+                param++;
+                off = 0;
+                continue;
             }
-            else if(code_line[i] == nterm)
+            else if(off >= sizeof(parameter_string[param]) - 1)
             {
-                if(param == 0) param = 1;
-                i++;
-                break;
+                compiler_error(ci, "parameter %zu of \"%.*s\" is too long", param, (int)ct->token.len, ct->token.str);
             }
 
             // If there is no special case we store it in param
-            parameter_string[param][off++] = code_line[i];
+            parameter_string[param][off++] = slice->str[i];
+        }
+    }
+
+    // Only compare and branch instructions take their target as third parameter, block instructions their length
+    bool branch = opcode->opcode >= LA16_OPCODE_BEQ && opcode->opcode <= LA16_OPCODE_BGE;
+    bool block = opcode->opcode >= LA16_OPCODE_MCPY && opcode->opcode <= LA16_OPCODE_MCMP;
+    if(branch && parameter_string[2][0] == '\0')
+    {
+        compiler_error(ci, "%s needs a branch target", opcode_string);
+    }
+    else if(block && parameter_string[2][0] == '\0')
+    {
+        compiler_error(ci, "%s needs a length register", opcode_string);
+    }
+    else if(!branch && !block && parameter_string[2][0] != '\0')
+    {
+        compiler_error(ci, "%s takes at most two parameters", opcode_string);
+    }
+
+    // Memory operands address through the second parameter of loads and the first of stores
+    unsigned short memory = 0;
+    for(unsigned char i = 0; i < 2; i++)
+    {
+        if(parameter_string[i][0] != '[')
+        {
+            continue;
         }
+
+        bool load = opcode->opcode == LA16_OPCODE_LDB || opcode->opcode == LA16_OPCODE_LDW;
+        bool store = opcode->opcode == LA16_OPCODE_STB || opcode->opcode == LA16_OPCODE_STW;
+        if(!(load && i == 1) && !(store && i == 0))
+        {
+            compiler_error(ci, "%s takes no memory operand as parameter %d", opcode_string, i);
+        }
+        memory = la16_compiler_memory_operand(parameter_string[i], ci);
     }
 
     // Now decode parameters
-    la16_compiler_lowcodeline_parameter_parser(parameter_string[0], scope, &ptc[0], &pv[0], ci);
-    la16_compiler_lowcodeline_parameter_parser(parameter_string[1], scope, &ptc[1], &pv[1], ci);
+    la16_compiler_lowcodeline_parameter_parser(parameter_string[0], scope, &ptc[0], &pv[0], &reloc[0], arena, ci);
+    la16_compiler_lowcodeline_parameter_parser(parameter_string[1], scope, &ptc[1], &pv[1], &reloc[1], arena, ci);
 
     // Check if their valid
     for(unsigned char i = 0; i < 2; i++)
     {
         if(ptc[i] == LA16_CODING_ERR)
         {
-            printf("[!] Parameter %d is unrecognised\n", i);
-            exit(1);
+            compiler_error(ci, "Parameter %d is unrecognised", i);
         }
     }
 
@@ -275,52 +449,180 @@ unsigned int la16_compiler_lowcodeline(const char *code_line, const char *scope,
 
     /* write opcode */
     cinstr.opcode = opcode->opcode;
+    cinstr.ext = memory;
 
     /* combine both modes into the real instruction mode */
     cinstr.mode = la16_mode_create_from_codings(ptc[0], ptc[1]);
 
+    /* blm carries a 16bit target next to its 5bit save mask */
+    if(cinstr.opcode == LA16_OPCODE_BLM && cinstr.mode == LA16_PARAMETER_CODING_COMBINATION_IMM8_IMM8)
+    {
+        cinstr.mode = LA16_PARAMETER_CODING_COMBINATION_IMM16_IMM5;
+    }
+
     /* iterating through the raw mini modes */
     for(unsigned char i = 0; i < 2; i++)
     {
         cinstr.arg[i] = pv[i];
     }
 
-    return la16_compiler_machinecode(&cinstr);
+    if(branch)
+    {
+        la16_compiler_branch(ct, scope, parameter_string[2], &cinstr, ci);
+    }
+    else if(block)
+    {
+        la16_compiler_block(parameter_string[2], &cinstr, ci);
+    }
+
+    return cinstr;
 }
 
-void la16_compiler_lowlevel(compiler_invocation_t *ci)
+unsigned int la16_compiler_lowcodeline(compiler_token_t *ct, const compiler_scope_t *scope, compiler_invocation_t *ci)
+{
+    compiler_object_reloc_t reloc[2];
+    la16_compiler_instruction_t cinstr = la16_compiler_lowcodeline_instruction(ct, scope, reloc, &ci->arena, ci);
+    return la16_compiler_machinecode(ci, &cinstr);
+}
+
+typedef struct {
+    unsigned long begin;                    /* first token of the chunk */
+    unsigned long end;                      /* token after the last one of the chunk */
+    unsigned long instr;                    /* index of the first instruction of the chunk */
+    compiler_scope_t scope;                 /* scope the chunk starts in */
+    compiler_arena_t arena;                 /* allocations of the chunk, adopted by the invocation */
+} la16_compiler_chunk_t;
+
+typedef struct {
+    compiler_invocation_t *ci;
+    la16_compiler_chunk_t *chunk;
+    compiler_object_reloc_t *reloc;         /* two relocation slots per instruction, relocatable output only */
+} la16_compiler_lowlevel_ctx_t;
+
+static void la16_compiler_lowlevel_scope(compiler_invocation_t *ci,
+                                         compiler_token_t *ct,
+                                         compiler_scope_t *scope)
+{
+    // If we encounter a none scoped label it means its a new scope
+    // The scope name points into the token, minus the trailing ':'
+    compiler_slice_t *name = code_token_subtoken(ci, ct, 0);
+    scope->name = name->str;
+    scope->len = name->len - 1;
+    scope->hash = compiler_symtab_hash(scope->name, scope->len, COMPILER_SYMTAB_HASH_SEED);
+}
+
+static void la16_compiler_lowlevel_chunk(void *arg,
+                                         unsigned long c)
 {
-    // Holds current scope
-    char *scope = NULL;
+    la16_compiler_lowlevel_ctx_t *ctx = arg;
+    compiler_invocation_t *ci = ctx->ci;
+    la16_compiler_chunk_t *chunk = &ctx->chunk[c];
 
-    // Iterating through tokens
-    for(unsigned long i = 0; i < ci->token_cnt; i++)
+    compiler_scope_t scope = chunk->scope;
+    unsigned long instr = chunk->instr;
+
+    // Labels and constants are resolved by now, every instruction goes into its own slot
+    for(unsigned long i = chunk->begin; i < chunk->end; i++)
     {
-        // Checking for label
         if(ci->token[i].type == COMPILER_TOKEN_TYPE_LABEL)
         {
-            // If we encounter a none scoped label it means its a new scope
+            la16_compiler_lowlevel_scope(ci, &ci->token[i], &scope);
+        }
+        else if(ci->token[i].type == COMPILER_TOKEN_TYPE_ASM)
+        {
+            const compiler_scope_t *sp = (scope.name != NULL) ? &scope : NULL;
 
-            // Checking if scope is null
-            if(scope != NULL)
+            if(ci->object != NULL)
             {
-                free(scope);
+                // Relocatable output keeps the instruction decomposed till link time
+                compiler_object_reloc_t *reloc = &ctx->reloc[instr * 2];
+                reloc[0].kind = COMPILER_OBJECT_RELOC_NONE;
+                reloc[1].kind = COMPILER_OBJECT_RELOC_NONE;
+                ci->object->text[instr] = la16_compiler_lowcodeline_instruction(&ci->token[i], sp, reloc, &chunk->arena, ci);
             }
-
-            size_t scope_size = strlen(ci->token[i].token);
-            scope = malloc(scope_size);
-            memcpy(scope, ci->token[i].token, scope_size - 1);
-            scope[scope_size - 1] = '\0';
+            else
+            {
+                compiler_object_reloc_t reloc[2];
+                la16_compiler_instruction_t cinstr = la16_compiler_lowcodeline_instruction(&ci->token[i], sp, reloc, &chunk->arena, ci);
+                unsigned int instruction = la16_compiler_machinecode(ci, &cinstr);
+                memcpy(&ci->image[ci->image_uaddr + instr * 4], &instruction, 4);
+            }
+            instr++;
         }
-        else if(ci->token[i].type == COMPILER_TOKEN_TYPE_ASM)
+    }
+}
+
+void la16_compiler_lowlevel(compiler_invocation_t *ci)
+{
+    // Splitting the tokens into chunks, a serial pass over the labels gives each its scope and first slot
+    unsigned long chunk_cnt = (ci->token_cnt + LA16_COMPILER_LOWLEVEL_CHUNK - 1) / LA16_COMPILER_LOWLEVEL_CHUNK;
+    la16_compiler_chunk_t *chunk = compiler_arena_calloc(&ci->arena, chunk_cnt, sizeof(la16_compiler_chunk_t));
+
+    compiler_scope_t scope = {};
+    unsigned long instr = 0;
+    for(unsigned long c = 0; c < chunk_cnt; c++)
+    {
+        chunk[c].begin = c * LA16_COMPILER_LOWLEVEL_CHUNK;
+        chunk[c].end = (chunk[c].begin + LA16_COMPILER_LOWLEVEL_CHUNK < ci->token_cnt) ? chunk[c].begin + LA16_COMPILER_LOWLEVEL_CHUNK : ci->token_cnt;
+        chunk[c].instr = instr;
+        chunk[c].scope = scope;
+        compiler_arena_init(&chunk[c].arena);
+
+        for(unsigned long i = chunk[c].begin; i < chunk[c].end; i++)
         {
-            unsigned int instruction = la16_compiler_lowcodeline(ci->token[i].token, scope, ci);
-            unsigned char *ibuf = (unsigned char*)&instruction;
-            for(unsigned char i = 0; i < 4; i++)
+            if(ci->token[i].type == COMPILER_TOKEN_TYPE_LABEL)
+            {
+                la16_compiler_lowlevel_scope(ci, &ci->token[i], &scope);
+            }
+            else if(ci->token[i].type == COMPILER_TOKEN_TYPE_ASM)
             {
-                ci->image[ci->image_uaddr + i] = ibuf[i];
+                instr++;
             }
-            ci->image_uaddr += 4;
         }
     }
+
+    la16_compiler_lowlevel_ctx_t ctx = {
+        .ci = ci,
+        .chunk = chunk,
+    };
+
+    if(ci->object != NULL)
+    {
+        ci->object->text = compiler_arena_alloc(&ci->arena, sizeof(la16_compiler_instruction_t) * instr);
+        ci->object->text_cnt = ci->object->text_cap = instr;
+        ctx.reloc = compiler_arena_alloc(&ci->arena, sizeof(compiler_object_reloc_t) * instr * 2);
+    }
+    else
+    {
+        code_image_reserve(ci, ci->image_uaddr + instr * 4);
+    }
+
+    // Encoding the chunks in parallel, catching the error so the chunk arenas are adopted either way
+    compiler_trap_t trap;
+    trap.diag.error = 0;
+    compiler_trap_t *outer = compiler_trap_set(&trap);
+    if(setjmp(trap.jmp) == 0)
+    {
+        compiler_parallel_for(ci, chunk_cnt, la16_compiler_lowlevel_chunk, &ctx);
+    }
+    compiler_trap_set(outer);
+
+    for(unsigned long c = 0; c < chunk_cnt; c++)
+    {
+        compiler_arena_adopt(&ci->arena, &chunk[c].arena);
+    }
+
+    if(trap.diag.error)
+    {
+        compiler_error(ci, "%s", trap.diag.message);
+    }
+
+    if(ci->object != NULL)
+    {
+        object_reloc_collect(ci, ctx.reloc, instr);
+    }
+    else
+    {
+        ci->image_uaddr += instr * 4;
+    }
 }
@@ -31,8 +31,12 @@
 #include <compiler/label.h>
 #include <compiler/constant.h>
 
+#define LA16_COMPILER_LOWLEVEL_CHUNK    1024    /* tokens encoded per work item */
+
 //unsigned int la16_compiler_machinecode(unsigned char opcode, unsigned char mode, unsigned char a, unsigned short b, unsigned short *c);
-unsigned int la16_compiler_lowcodeline(const char *code_line, const char *scope, compiler_invocation_t *ci);
+unsigned int la16_compiler_machinecode(compiler_invocation_t *ci, la16_compiler_instruction_t *cinstr);
+la16_compiler_instruction_t la16_compiler_lowcodeline_instruction(compiler_token_t *ct, const compiler_scope_t *scope, compiler_object_reloc_t *reloc, compiler_arena_t *arena, compiler_invocation_t *ci);
+unsigned int la16_compiler_lowcodeline(compiler_token_t *ct, const compiler_scope_t *scope, compiler_invocation_t *ci);
 void la16_compiler_lowlevel(compiler_invocation_t *ci);
 
 #endif /* LA16_COMPILER_H */
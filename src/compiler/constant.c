@@ -25,21 +25,70 @@
 #include <compiler/constant.h>
 #include <compiler/parse.h>
 #include <compiler/label.h>
+#include <compiler/symtab.h>
+#include <compiler/code.h>
+#include <compiler/error.h>
+#include <compiler/object.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-unsigned int code_token_constant_lookup(compiler_invocation_t *ci, const char *name)
+static unsigned long code_token_constant_find(compiler_invocation_t *ci,
+                                              const char *name,
+                                              size_t name_len,
+                                              unsigned int hash)
 {
-    // Iterating all constants to find the correct constants
-    for(int i = 0; i < ci->constant_cnt; i++)
+    // Probing all constants with the same hash
+    unsigned long pos = hash;
+    unsigned long idx;
+    while((idx = compiler_symtab_probe(&ci->constant_symtab, hash, &pos)) != COMPILER_SYMTAB_NOT_FOUND)
     {
-        if(strcmp(ci->constant[i].name, name) == 0)
+        if(ci->constant[idx].name_len == name_len &&
+           memcmp(ci->constant[idx].name, name, name_len) == 0)
         {
-            return ci->constant[i].value;
+            return idx;
         }
     }
-    return COMPILER_CONSTANT_NOT_FOUND;
+    return COMPILER_SYMTAB_NOT_FOUND;
+}
+
+unsigned int code_token_constant_lookup(compiler_invocation_t *ci, const char *name)
+{
+    size_t name_len = strlen(name);
+    unsigned int hash = compiler_symtab_hash(name, name_len, COMPILER_SYMTAB_HASH_SEED);
+    unsigned long idx = code_token_constant_find(ci, name, name_len, hash);
+    if(idx == COMPILER_SYMTAB_NOT_FOUND)
+    {
+        return COMPILER_CONSTANT_NOT_FOUND;
+    }
+    return ci->constant[idx].value;
+}
+
+void constant_insert(compiler_invocation_t *ci,
+                     const char *name,
+                     unsigned short name_len,
+                     unsigned short value)
+{
+    // Growing constant array if needed
+    if(ci->constant_cnt >= ci->constant_cap)
+    {
+        unsigned long old_cap = ci->constant_cap;
+        ci->constant_cap = (ci->constant_cap == 0) ? 16 : ci->constant_cap * 2;
+        ci->constant = compiler_arena_realloc(&ci->arena, ci->constant, sizeof(compiler_constant_t) * old_cap, sizeof(compiler_constant_t) * ci->constant_cap);
+    }
+
+    ci->constant[ci->constant_cnt].name = name;
+    ci->constant[ci->constant_cnt].name_len = name_len;
+    ci->constant[ci->constant_cnt].value = value;
+
+    // Indexing constant, the first definition of a name wins
+    unsigned int hash = compiler_symtab_hash(name, name_len, COMPILER_SYMTAB_HASH_SEED);
+    if(code_token_constant_find(ci, name, name_len, hash) == COMPILER_SYMTAB_NOT_FOUND)
+    {
+        compiler_symtab_insert(&ci->constant_symtab, hash, ci->constant_cnt);
+    }
+
+    ci->constant_cnt++;
 }
 
 void code_token_constant(compiler_invocation_t *ci)
@@ -55,9 +104,10 @@ void code_token_constant(compiler_invocation_t *ci)
         }
     }
 
-    // Allocate compiler label array
-    ci->constant = calloc(ci->constant_cnt, sizeof(compiler_constant_t));
-    memset(ci->constant, 0, sizeof(compiler_constant_t) * ci->constant_cnt);
+    // Allocate compiler constant array and its index
+    ci->constant_cap = ci->constant_cnt;
+    ci->constant = compiler_arena_calloc(&ci->arena, ci->constant_cnt, sizeof(compiler_constant_t));
+    compiler_symtab_init(&ci->constant_symtab, &ci->arena, ci->constant_cnt);
 
     // Now parse the position of each label
     ci->constant_cnt = 0;
@@ -65,42 +115,54 @@ void code_token_constant(compiler_invocation_t *ci)
     {
         if(ci->token[i].type == COMPILER_TOKEN_TYPE_CONSTANT)
         {
-            char *name = strdup(ci->token[i].subtoken[1]);
+            compiler_slice_t *name = code_token_subtoken(ci, &ci->token[i], 1);
+
+            char value[256];
+            code_slice_copy(ci, code_token_subtoken(ci, &ci->token[i], 2), value, sizeof(value));
 
-            parse_type_return_t pr = parse_type_lc(ci->token[i].subtoken[2]);
+            parse_type_return_t pr = parse_type_lc(value, &ci->arena);
+            unsigned short cvalue = 0;
 
             switch(pr.type)
             {
                 case PARSE_TYPE_STRING:
+                    /* relocatable output leaves label references to the linker */
+                    if(ci->object != NULL)
+                    {
+                        object_symbol_push(ci, name->str, name->len, COMPILER_OBJECT_SYMBOL_ALIAS, 0, compiler_arena_strdup(&ci->arena, value), 0);
+                        continue;
+                    }
+
                     /* could be a label */
-                    ci->constant[ci->constant_cnt].name = name;
-                    unsigned int addr = label_lookup(ci, ci->token[i].subtoken[2], NULL);
+                    unsigned int addr = label_lookup(ci, value, NULL);
 
                     if(addr == COMPILER_LABEL_NOT_FOUND)
                     {
-                        printf("[!] lookup: %s not found\n", ci->token[i].subtoken[2]);
-                        exit(1);
+                        compiler_error(ci, "lookup: %s not found", value);
                     }
 
-                    ci->constant[ci->constant_cnt].value = (unsigned short)addr;
+                    cvalue = (unsigned short)addr;
 
                     break;
                 case PARSE_TYPE_NUMBER:
                 case PARSE_TYPE_HEX:
                 case PARSE_TYPE_BIN:
                 case PARSE_TYPE_CHAR:
-                    ci->constant[ci->constant_cnt].name = name;
-                    ci->constant[ci->constant_cnt].value = pr.value;
+                    if(ci->object != NULL)
+                    {
+                        object_symbol_push(ci, name->str, name->len, COMPILER_OBJECT_SYMBOL_ABS, pr.value, NULL, 0);
+                        continue;
+                    }
+
+                    cvalue = pr.value;
                     break;
                 case PARSE_TYPE_BUFFER:
-                    printf("[!] buffers in constant not supported\n");
-                    exit(1);
+                    compiler_error(ci, "buffers in constant not supported");
                 default:
-                    printf("[!] fatal: parse type not recognized\n");
-                    exit(1);
+                    compiler_error(ci, "fatal: parse type not recognized");
             }
 
-            ci->constant_cnt++;
+            constant_insert(ci, name->str, name->len, cvalue);
         }
     }
 }
\ No newline at end of file
@@ -31,5 +31,6 @@
 
 unsigned int code_token_constant_lookup(compiler_invocation_t *ci, const char *name);
 void code_token_constant(compiler_invocation_t *ci);
+void constant_insert(compiler_invocation_t *ci, const char *name, unsigned short name_len, unsigned short value);
 
 #endif /* COMPILER_CONSTANT_H */
\ No newline at end of file
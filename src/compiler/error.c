@@ -0,0 +1,73 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <compiler/error.h>
+
+static _Thread_local compiler_trap_t *compiler_error_trap = NULL;
+
+compiler_trap_t *compiler_trap_set(compiler_trap_t *trap)
+{
+    compiler_trap_t *prev = compiler_error_trap;
+    compiler_error_trap = trap;
+    return prev;
+}
+
+void compiler_error(compiler_invocation_t *ci,
+                    const char *fmt,
+                    ...)
+{
+    char message[LA16_DIAG_MESSAGE_MAX];
+
+    /* formatting the message */
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(message, sizeof(message), fmt, args);
+    va_end(args);
+
+    /* worker threads hand the error back to their owner */
+    if(compiler_error_trap != NULL)
+    {
+        compiler_error_trap->diag.error = 1;
+        snprintf(compiler_error_trap->diag.message, sizeof(compiler_error_trap->diag.message), "%s", message);
+        longjmp(compiler_error_trap->jmp, 1);
+    }
+
+    /* in process invocations get the error handed back */
+    if(ci->fail != NULL)
+    {
+        if(ci->diag != NULL)
+        {
+            ci->diag->error = 1;
+            snprintf(ci->diag->message, sizeof(ci->diag->message), "%s", message);
+        }
+        longjmp(*ci->fail, 1);
+    }
+
+    printf("[!] %s\n", message);
+    exit(1);
+}
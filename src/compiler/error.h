@@ -0,0 +1,44 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef COMPILER_ERROR_H
+#define COMPILER_ERROR_H
+
+#include <setjmp.h>
+#include <compiler/type.h>
+
+/*
+ * A trap catches errors of the calling thread regardless of the
+ * invocation they are raised on, worker threads use it to hand
+ * their errors back to the thread that owns the invocation
+ */
+typedef struct {
+    jmp_buf jmp;
+    la16_diag_t diag;
+} compiler_trap_t;
+
+compiler_trap_t *compiler_trap_set(compiler_trap_t *trap);
+void compiler_error(compiler_invocation_t *ci, const char *fmt, ...) __attribute__((noreturn, format(printf, 2, 3)));
+
+#endif /* COMPILER_ERROR_H */
@@ -0,0 +1,296 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <compiler/frame.h>
+#include <compiler/code.h>
+#include <compiler/register.h>
+#include <compiler/symtab.h>
+#include <compiler/error.h>
+
+void frame_insert(compiler_invocation_t *ci,
+                  const char *name,
+                  unsigned short name_len,
+                  unsigned char mask)
+{
+    // Growing frame array if needed
+    if(ci->frame_cnt >= ci->frame_cap)
+    {
+        unsigned long old_cap = ci->frame_cap;
+        ci->frame_cap = (ci->frame_cap == 0) ? 16 : ci->frame_cap * 2;
+        ci->frame = compiler_arena_realloc(&ci->arena, ci->frame, sizeof(compiler_frame_t) * old_cap, sizeof(compiler_frame_t) * ci->frame_cap);
+    }
+
+    // The index is created lazily, most invocations never see a retm
+    if(ci->frame_symtab.arena == NULL)
+    {
+        compiler_symtab_init(&ci->frame_symtab, &ci->arena, 0);
+    }
+
+    compiler_frame_t *frame = &ci->frame[ci->frame_cnt];
+    frame->name = name;
+    frame->name_len = name_len;
+    frame->mask = mask;
+
+    compiler_symtab_insert(&ci->frame_symtab, compiler_symtab_hash(name, name_len, COMPILER_SYMTAB_HASH_SEED), ci->frame_cnt);
+    ci->frame_cnt++;
+}
+
+int frame_lookup(compiler_invocation_t *ci,
+                 const char *name,
+                 unsigned short name_len)
+{
+    if(ci->frame_cnt == 0)
+    {
+        return COMPILER_FRAME_NOT_FOUND;
+    }
+
+    unsigned int hash = compiler_symtab_hash(name, name_len, COMPILER_SYMTAB_HASH_SEED);
+    unsigned long pos = hash;
+    unsigned long idx;
+    while((idx = compiler_symtab_probe(&ci->frame_symtab, hash, &pos)) != COMPILER_SYMTAB_NOT_FOUND)
+    {
+        compiler_frame_t *frame = &ci->frame[idx];
+        if(frame->name_len == name_len && memcmp(frame->name, name, name_len) == 0)
+        {
+            return frame->mask;
+        }
+    }
+    return COMPILER_FRAME_NOT_FOUND;
+}
+
+static bool frame_token_is(compiler_invocation_t *ci,
+                           compiler_token_t *ct,
+                           const char *mnemonic)
+{
+    return code_slice_equal(code_token_subtoken(ci, ct, 0), mnemonic);
+}
+
+static unsigned char frame_register_mask(unsigned char reg)
+{
+    if(reg == LA16_REGISTER_CF)
+    {
+        return LA16_CALL_SAVE_CF;
+    }
+    else if(reg >= LA16_REGISTER_R0 && reg <= LA16_REGISTER_R6)
+    {
+        return LA16_CALL_SAVE_R0_R6;
+    }
+    else if(reg >= LA16_REGISTER_R7 && reg <= LA16_REGISTER_R12)
+    {
+        return LA16_CALL_SAVE_R7_R12;
+    }
+    else if(reg >= LA16_REGISTER_R13 && reg <= LA16_REGISTER_R18)
+    {
+        return LA16_CALL_SAVE_R13_R18;
+    }
+    else if(reg >= LA16_REGISTER_R19 && reg <= LA16_REGISTER_R24)
+    {
+        return LA16_CALL_SAVE_R19_R24;
+    }
+    return LA16_CALL_SAVE_NONE;
+}
+
+/* instructions that only read their operands */
+static const char *frame_write_none[] = {
+    "cmp", "push", "out", "stb", "stw", "jmp", "je", "jne", "jlt", "jgt", "jle", "jge",
+    "intset", "vpset", "vpflgset", "beq", "bne", "blt", "bgt", "ble", "bge",
+    "mcpy", "mset", "mcmp", "crtimeset", "crresume", "bnkset", NULL
+};
+
+/* instructions that write both of their operands */
+static const char *frame_write_both[] = {
+    "swp", "swpz", "inc", "dec", "not", NULL
+};
+
+static bool frame_token_in(compiler_invocation_t *ci,
+                           compiler_token_t *ct,
+                           const char **mnemonic)
+{
+    for(unsigned long i = 0; mnemonic[i] != NULL; i++)
+    {
+        if(frame_token_is(ci, ct, mnemonic[i]))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * register groups an instruction writes, anything else writes its first
+ * operand, a post incremented memory operand writes its address register
+ */
+static unsigned char frame_token_mask(compiler_invocation_t *ci,
+                                      compiler_token_t *ct)
+{
+    unsigned char mask = (frame_token_is(ci, ct, "cmp") || frame_token_is(ci, ct, "mcmp")) ? LA16_CALL_SAVE_CF : LA16_CALL_SAVE_NONE;
+    unsigned long written = frame_token_in(ci, ct, frame_write_none) ? 0 : frame_token_in(ci, ct, frame_write_both) ? 2 : 1;
+
+    // Operands are separated by commas, which may share a subtoken with them
+    char name[2][16] = {};
+    unsigned long len[2] = {};
+    unsigned long param = 0;
+    for(unsigned long st = 1; st < ct->subtoken_cnt && param < 2; st++)
+    {
+        compiler_slice_t *slice = code_token_subtoken(ci, ct, st);
+        for(unsigned long i = 0; i < slice->len && param < 2; i++)
+        {
+            if(slice->str[i] == ',')
+            {
+                param++;
+            }
+            else if(len[param] < sizeof(name[param]) - 1)
+            {
+                name[param][len[param]++] = slice->str[i];
+            }
+        }
+    }
+
+    for(unsigned long i = 0; i < 2; i++)
+    {
+        char *reg_name = name[i];
+        if(reg_name[0] == '[' && len[i] > 3 && strcmp(&reg_name[len[i] - 2], "]+") == 0)
+        {
+            reg_name[len[i] - 2] = '\0';
+            reg_name++;
+        }
+        else if(i >= written)
+        {
+            continue;
+        }
+
+        register_entry_t *reg = register_from_string(reg_name);
+        if(reg != NULL)
+        {
+            mask |= frame_register_mask(reg->reg);
+        }
+    }
+
+    return mask;
+}
+
+static void frame_function_end(compiler_invocation_t *ci,
+                               const compiler_slice_t *name,
+                               bool ret,
+                               bool retm,
+                               unsigned char mask)
+{
+    if(!retm)
+    {
+        return;
+    }
+
+    // Callers cannot know which of both frames the function pops
+    if(ret)
+    {
+        compiler_error(ci, "%.*s returns with both ret and retm", (int)name->len - 1, name->str);
+    }
+
+    frame_insert(ci, name->str, name->len - 1, mask);
+}
+
+/*
+ * functions that return with retm have to be entered with blm, the
+ * save mask covers every register the function writes between its
+ * label and the next unscoped one. calls and interrupts in between
+ * restore what they change, so they dont count, the same goes for
+ * the push, mov and pop around a call. each bl to such a function is
+ * rewritten into a blm with that mask
+ */
+void code_token_frame(compiler_invocation_t *ci)
+{
+    compiler_slice_t name = {};
+    bool ret = false;
+    bool retm = false;
+    unsigned char mask = LA16_CALL_SAVE_NONE;
+
+    for(unsigned long i = 0; i < ci->token_cnt; i++)
+    {
+        compiler_token_t *ct = &ci->token[i];
+
+        if(ct->type == COMPILER_TOKEN_TYPE_LABEL)
+        {
+            frame_function_end(ci, &name, ret, retm, mask);
+
+            name = *code_token_subtoken(ci, ct, 0);
+            ret = false;
+            retm = false;
+            mask = LA16_CALL_SAVE_NONE;
+        }
+        else if(ct->type == COMPILER_TOKEN_TYPE_ASM && name.str != NULL)
+        {
+            if(frame_token_is(ci, ct, "retm"))
+            {
+                retm = true;
+            }
+            else if(frame_token_is(ci, ct, "ret"))
+            {
+                ret = true;
+            }
+            else if(!(ct->flags & COMPILER_TOKEN_FLAG_CALL) &&
+                    !frame_token_is(ci, ct, "bl") &&
+                    !frame_token_is(ci, ct, "blm") &&
+                    !frame_token_is(ci, ct, "int"))
+            {
+                mask |= frame_token_mask(ci, ct);
+            }
+        }
+    }
+    frame_function_end(ci, &name, ret, retm, mask);
+
+    if(ci->frame_cnt == 0)
+    {
+        return;
+    }
+
+    for(unsigned long i = 0; i < ci->token_cnt; i++)
+    {
+        compiler_token_t *ct = &ci->token[i];
+        if(ct->type != COMPILER_TOKEN_TYPE_ASM || ct->subtoken_cnt != 2 || !frame_token_is(ci, ct, "bl"))
+        {
+            continue;
+        }
+
+        // Copying the target, pushing subtokens may move the array
+        compiler_slice_t target = *code_token_subtoken(ci, ct, 1);
+        int target_mask = frame_lookup(ci, target.str, target.len);
+        if(target_mask == COMPILER_FRAME_NOT_FOUND)
+        {
+            continue;
+        }
+
+        char *mask_str = compiler_arena_alloc(&ci->arena, 4);
+        snprintf(mask_str, 4, "%d", target_mask);
+
+        ct->subtoken = ci->subtoken_cnt;
+        ct->subtoken_cnt = 0;
+        code_subtoken_push(ci, ct, "blm", 3);
+        code_subtoken_push(ci, ct, target.str, target.len);
+        code_subtoken_push(ci, ct, ",", 1);
+        code_subtoken_push(ci, ct, mask_str, strlen(mask_str));
+    }
+}
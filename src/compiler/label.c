@@ -28,171 +28,217 @@
 #include <string.h>
 #include <ctype.h>
 #include <compiler/label.h>
+#include <compiler/symtab.h>
+#include <compiler/code.h>
+#include <compiler/error.h>
+
+static inline char label_key_at(const char *a,
+                                size_t alen,
+                                const char *b,
+                                size_t i)
+{
+    return (i < alen) ? a[i] : b[i - alen];
+}
 
-bool code_label_exists(compiler_invocation_t *ci,
-                       const char *name)
+/*
+ * compares the key of a label against a key split into scope and name,
+ * the split point may differ so "_puts" + ".loop" matches "_puts.loop"
+ */
+static bool label_key_equal(const compiler_label_t *label,
+                            const char *scope,
+                            size_t scope_len,
+                            const char *name,
+                            size_t name_len)
 {
-    for (int i = 0; i < ci->label_cnt; i++)
+    /* checking if total lengths match */
+    if((size_t)label->scope_len + label->name_len != scope_len + name_len)
+    {
+        return false;
+    }
+
+    /* fast path, both keys are split at the same position */
+    if(label->scope_len == scope_len)
+    {
+        return (scope_len == 0 || memcmp(label->scope, scope, scope_len) == 0) &&
+               memcmp(label->name, name, name_len) == 0;
+    }
+
+    /* slow path, walking both keys character by character */
+    for(size_t i = 0; i < scope_len + name_len; i++)
     {
-        if (strcmp(ci->label[i].name, name) == 0)
+        if(label_key_at(label->scope, label->scope_len, label->name, i) != label_key_at(scope, scope_len, name, i))
         {
-            return true;
+            return false;
         }
     }
-    return false;
+
+    return true;
+}
+
+static unsigned long label_find(compiler_invocation_t *ci,
+                                const char *scope,
+                                size_t scope_len,
+                                const char *name,
+                                size_t name_len,
+                                unsigned int hash)
+{
+    /* probing all labels with the same hash */
+    unsigned long pos = hash;
+    unsigned long idx;
+    while((idx = compiler_symtab_probe(&ci->label_symtab, hash, &pos)) != COMPILER_SYMTAB_NOT_FOUND)
+    {
+        if(label_key_equal(&ci->label[idx], scope, scope_len, name, name_len))
+        {
+            return idx;
+        }
+    }
+    return COMPILER_SYMTAB_NOT_FOUND;
+}
+
+void label_insert(compiler_invocation_t *ci,
+                  const char *scope,
+                  unsigned short scope_len,
+                  const char *name,
+                  unsigned short name_len,
+                  unsigned short addr,
+                  unsigned char rel)
+{
+    /* hashing name, scoped labels continue from the hash of their scope */
+    unsigned int hash = compiler_symtab_hash(scope, scope_len, COMPILER_SYMTAB_HASH_SEED);
+    hash = compiler_symtab_hash(name, name_len, hash);
+
+    // Checking for duplicated labels
+    if(label_find(ci, scope, scope_len, name, name_len, hash) != COMPILER_SYMTAB_NOT_FOUND)
+    {
+        compiler_error(ci, "duplicate label: %.*s%.*s", scope_len, scope, name_len, name);
+    }
+
+    // Growing label array if needed
+    if(ci->label_cnt >= ci->label_cap)
+    {
+        unsigned long old_cap = ci->label_cap;
+        ci->label_cap = (ci->label_cap == 0) ? 16 : ci->label_cap * 2;
+        ci->label = compiler_arena_realloc(&ci->arena, ci->label, sizeof(compiler_label_t) * old_cap, sizeof(compiler_label_t) * ci->label_cap);
+    }
+
+    compiler_label_t *label = &ci->label[ci->label_cnt];
+    label->scope = scope;
+    label->scope_len = scope_len;
+    label->name = name;
+    label->name_len = name_len;
+    label->addr = addr;
+    label->rel = rel;
+
+    compiler_symtab_insert(&ci->label_symtab, hash, ci->label_cnt);
+    ci->label_cnt++;
 }
 
 void code_token_label(compiler_invocation_t *ci)
 {
-    ci->label_cnt = 0;
+    unsigned long label_cnt = 0;
 
     // Find out how many labels there are
-    for(int i = 0; i < ci->token_cnt; i++)
+    for(unsigned long i = 0; i < ci->token_cnt; i++)
     {
         if(ci->token[i].type == COMPILER_TOKEN_TYPE_LABEL ||
            ci->token[i].type == COMPILER_TOKEN_TYPE_LABEL_SCOPED)
         {
-            (ci->label_cnt)++;
+            label_cnt++;
         }
     }
 
-    // Allocate compiler label array
-    ci->label = calloc(ci->label_cnt, sizeof(compiler_label_t));
-    memset(ci->label, 0, sizeof(compiler_label_t) * ci->label_cnt);
+    // Allocate compiler label array and its index
+    ci->label_cnt = 0;
+    ci->label_cap = label_cnt;
+    ci->label = compiler_arena_calloc(&ci->arena, label_cnt, sizeof(compiler_label_t));
+    compiler_symtab_init(&ci->label_symtab, &ci->arena, label_cnt);
 
     // Now parse the position of each label
-    ci->label_cnt = 0;
-    for(int i = 0; i < ci->token_cnt; i++)
+    const char *scope = NULL;
+    unsigned short scope_len = 0;
+    for(unsigned long i = 0; i < ci->token_cnt; i++)
     {
+        // Label names point into their tokens, minus the trailing ':'
+        compiler_slice_t *st = code_token_subtoken(ci, &ci->token[i], 0);
+        const char *name = st->str;
+        unsigned short name_len = st->len - 1;
+
         if(ci->token[i].type == COMPILER_TOKEN_TYPE_LABEL)
         {
-            size_t size = strlen(ci->token[i].token);
-            char *name = malloc(size);
-            memcpy(name, ci->token[i].token, size - 1);
-            name[size - 1] = '\0';
-
-            // Checking for duplicated labels
-            if(code_label_exists(ci, name))
-            {
-                printf("[!] duplicate label: %s\n", name);
-                exit(1);
-            }
-
-            // Set scope label index
-            ci->scope_label_idx = ci->label_cnt;
-
-            ci->label[ci->label_cnt].name = name;
-            ci->label[ci->label_cnt].addr = ci->token[i].addr;
-            ci->label[ci->label_cnt].rel = 1;
-            ci->label_cnt++;
-            continue;
+            // Its a new scope
+            scope = name;
+            scope_len = name_len;
+            label_insert(ci, NULL, 0, name, name_len, ci->token[i].addr, 1);
         }
         else if(ci->token[i].type == COMPILER_TOKEN_TYPE_LABEL_SCOPED)
         {
-            // Woah its a scoped label :/ Im so cooked now
-            // What is if people will have problems
-            // RAWWRRR I just bite em
-
-            // Getting individual sizes
-            size_t scope_label_name_size = strlen(ci->label[ci->scope_label_idx].name);
-            size_t scoped_label_name_size = strlen(ci->token[i].token);
-            size_t total_size = scope_label_name_size + scoped_label_name_size;
-
-            // Allocating the total size
-            char *name = malloc(total_size);
-
-            // Now it gets complex, we copy first the scope label name and then the scoped label name
-            memcpy(name, ci->label[ci->scope_label_idx].name, scope_label_name_size);
-            memcpy(name + scope_label_name_size, ci->token[i].token, scoped_label_name_size - 1);
-
-            // Null terminating
-            name[total_size - 1] = '\0';
-
-            // Checking for duplicated labels
-            if(code_label_exists(ci, name))
-            {
-                printf("[!] duplicate label: %s\n", name);
-                exit(-1);
-            }
-
-            ci->label[ci->label_cnt].name = name;
-            ci->label[ci->label_cnt].addr = ci->token[i].addr;
-            ci->label[ci->label_cnt].rel = 1;
-            ci->label_cnt++;
-            continue;
+            // Scoped labels are keyed by their scope label name followed by their own name
+            label_insert(ci, scope, scope_len, name, name_len, ci->token[i].addr, 1);
         }
     }
 }
 
-unsigned int label_lookup(compiler_invocation_t *ci,
-                            const char *name,
-                            const char *scope)
+const compiler_label_t *label_lookup_label(compiler_invocation_t *ci,
+                                          const char *name,
+                                          const compiler_scope_t *scope)
 {
-    // defines the actual lookup target
-    char *lookup_target = NULL;
+    size_t name_len = strlen(name);
+    unsigned long idx = COMPILER_SYMTAB_NOT_FOUND;
 
     // Looking if name has a dot
     if(name[0] == '.')
     {
         // Its meant to be in a scope!
-        
-        // Getting sizes
-        size_t name_size = strlen(name);
-        size_t scope_size = strlen(scope);
-        size_t total_size = name_size + scope_size;
-
-        // Allocating size
-        lookup_target = malloc(total_size + 1);
-
-        // Copying to lookup target
-        memcpy(lookup_target, scope, scope_size);
-        memcpy(lookup_target + scope_size, name, name_size);
-        lookup_target[total_size] = '\0';
+        if(scope == NULL)
+        {
+            return NULL;
+        }
+
+        unsigned int hash = compiler_symtab_hash(name, name_len, scope->hash);
+        idx = label_find(ci, scope->name, scope->len, name, name_len, hash);
     }
     else
     {
         // Its not meant to be in a scope!
-        lookup_target = (char*)name;
+        unsigned int hash = compiler_symtab_hash(name, name_len, COMPILER_SYMTAB_HASH_SEED);
+        idx = label_find(ci, NULL, 0, name, name_len, hash);
     }
 
-    // Iterating all labels to find the correct label
-    unsigned int addr = COMPILER_LABEL_NOT_FOUND;
-    for(int i = 0; i < ci->label_cnt; i++)
+    if(idx == COMPILER_SYMTAB_NOT_FOUND)
     {
-        if(strcmp(ci->label[i].name, lookup_target) == 0)
-        {
-            if(ci->label[i].rel == 0)
-            {
-                addr = ci->label[i].addr;
-                break;
-            }
-            else
-            {
-                addr = ci->label[i].addr + ci->image_text_start;
-                break;
-            }
-        }
+        return NULL;
     }
+    return &ci->label[idx];
+}
 
-    /* checking if lookup_target is name, if not release its memory */
-    if(lookup_target != name)
+unsigned int label_lookup(compiler_invocation_t *ci,
+                          const char *name,
+                          const compiler_scope_t *scope)
+{
+    const compiler_label_t *label = label_lookup_label(ci, name, scope);
+    if(label == NULL)
     {
-        free(lookup_target);
+        return COMPILER_LABEL_NOT_FOUND;
     }
 
-    return addr;
+    /* relative labels live in the text region */
+    if(label->rel == 0)
+    {
+        return label->addr;
+    }
+    return label->addr + ci->image_text_start;
 }
 
 void code_token_label_insert_start(compiler_invocation_t *ci)
 {
     /* finding start label */
-    unsigned short addr = label_lookup(ci, "_start", NULL);
-    if(addr == 0xFFFF)
+    unsigned int addr = label_lookup(ci, "_start", NULL);
+    if(addr == COMPILER_LABEL_NOT_FOUND)
     {
-        exit(1);
+        compiler_error(ci, "_start label not found");
     }
 
     /* writing start address into the start of the image */
     unsigned short *entry = (unsigned short*)&(ci->image[0]);
-    *entry = addr;
+    *entry = (unsigned short)addr;
 }
\ No newline at end of file
@@ -32,6 +32,8 @@
 void code_token_label(compiler_invocation_t *ci);
 void code_token_label_insert_start(compiler_invocation_t *ci);
 
-unsigned int label_lookup(compiler_invocation_t *ci, const char *name, const char *scope);
+void label_insert(compiler_invocation_t *ci, const char *scope, unsigned short scope_len, const char *name, unsigned short name_len, unsigned short addr, unsigned char rel);
+const compiler_label_t *label_lookup_label(compiler_invocation_t *ci, const char *name, const compiler_scope_t *scope);
+unsigned int label_lookup(compiler_invocation_t *ci, const char *name, const compiler_scope_t *scope);
 
 #endif /* COMPILER_LABEL_H */
@@ -0,0 +1,208 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <compiler/link.h>
+#include <compiler/label.h>
+#include <compiler/constant.h>
+#include <compiler/compiler.h>
+#include <compiler/symtab.h>
+#include <compiler/error.h>
+#include <compiler/parallel.h>
+#include <compiler/code.h>
+#include <compiler/frame.h>
+
+static unsigned short link_reloc_value(compiler_invocation_t *ci,
+                                       const compiler_object_reloc_t *reloc,
+                                       unsigned short data_base,
+                                       unsigned short text_base)
+{
+    switch(reloc->kind)
+    {
+        case COMPILER_OBJECT_RELOC_DATA:
+            return data_base + reloc->addend;
+        case COMPILER_OBJECT_RELOC_TEXT:
+            return text_base + reloc->addend;
+        case COMPILER_OBJECT_RELOC_SYMBOL:
+            /* same order as the parameter parser, labels before constants */
+            unsigned int addr = label_lookup(ci, reloc->name, NULL);
+            if(addr != COMPILER_LABEL_NOT_FOUND)
+            {
+                return addr;
+            }
+
+            unsigned int const_value = code_token_constant_lookup(ci, reloc->name);
+            if(const_value == COMPILER_CONSTANT_NOT_FOUND)
+            {
+                compiler_error(ci, "lookup: %s doesnt exist", reloc->name);
+            }
+            return const_value;
+        default:
+            compiler_error(ci, "illegal relocation: 0x%x", reloc->kind);
+    }
+}
+
+typedef struct {
+    compiler_invocation_t *ci;
+    compiler_object_t *object;
+    unsigned short *data_base;
+    unsigned short *text_base;
+} link_ctx_t;
+
+static void link_encode_object(void *arg,
+                               unsigned long i)
+{
+    link_ctx_t *ctx = arg;
+    compiler_invocation_t *ci = ctx->ci;
+    compiler_object_t *object = &ctx->object[i];
+
+    /* symbol tables are read only by now, so objects relocate independently */
+    for(unsigned long r = 0; r < object->reloc_cnt; r++)
+    {
+        compiler_object_reloc_t *reloc = &object->reloc[r];
+        la16_compiler_instruction_t *cinstr = &object->text[reloc->instr];
+        cinstr->arg[reloc->arg] = link_reloc_value(ci, reloc, ctx->data_base[i], ctx->text_base[i]);
+
+        /* a bl into a function of another object that returns with retm becomes a blm */
+        if(reloc->kind == COMPILER_OBJECT_RELOC_SYMBOL &&
+           reloc->arg == 0 &&
+           cinstr->opcode == LA16_OPCODE_BL &&
+           cinstr->mode == LA16_PARAMETER_CODING_COMBINATION_IMM16)
+        {
+            int mask = frame_lookup(ci, reloc->name, strlen(reloc->name));
+            if(mask != COMPILER_FRAME_NOT_FOUND)
+            {
+                cinstr->opcode = LA16_OPCODE_BLM;
+                cinstr->mode = LA16_PARAMETER_CODING_COMBINATION_IMM16_IMM5;
+                cinstr->arg[1] = mask;
+            }
+        }
+    }
+
+    /* every object encodes into its own slice of the image */
+    for(unsigned long j = 0; j < object->text_cnt; j++)
+    {
+        unsigned int instruction = la16_compiler_machinecode(ci, &object->text[j]);
+        memcpy(&ci->image[ctx->text_base[i] + j * 4], &instruction, 4);
+    }
+}
+
+void link_objects(compiler_invocation_t *ci,
+                  compiler_object_t *object,
+                  unsigned long object_cnt)
+{
+    unsigned short *data_base = compiler_arena_calloc(&ci->arena, object_cnt, sizeof(unsigned short));
+    unsigned short *text_base = compiler_arena_calloc(&ci->arena, object_cnt, sizeof(unsigned short));
+
+    /*
+     * Laying out the image the way a single assembly of all files would,
+     * data regions back to back after the header, then the text regions
+     * starting at the next 4 byte boundary
+     */
+    unsigned long addr = ci->image_uaddr;
+    for(unsigned long i = 0; i < object_cnt; i++)
+    {
+        data_base[i] = addr;
+        addr += object[i].data_size;
+        code_image_reserve(ci, addr);
+    }
+
+    addr = (addr + 3) & ~0x3;
+    ci->image_text_start = addr;
+
+    unsigned long symbol_cnt = 0;
+    for(unsigned long i = 0; i < object_cnt; i++)
+    {
+        text_base[i] = addr;
+        addr += object[i].text_cnt * 4;
+        symbol_cnt += object[i].symbol_cnt;
+        code_image_reserve(ci, addr);
+    }
+
+    /* the image is sized from the layout, so it does not move anymore */
+    for(unsigned long i = 0; i < object_cnt; i++)
+    {
+        memcpy(&ci->image[data_base[i]], object[i].data, object[i].data_size);
+    }
+
+    /* global symbols, labels go first so constants can alias them */
+    compiler_symtab_init(&ci->label_symtab, &ci->arena, symbol_cnt);
+    compiler_symtab_init(&ci->constant_symtab, &ci->arena, symbol_cnt);
+
+    for(unsigned long i = 0; i < object_cnt; i++)
+    {
+        for(unsigned long j = 0; j < object[i].symbol_cnt; j++)
+        {
+            compiler_object_symbol_t *symbol = &object[i].symbol[j];
+            if(symbol->kind == COMPILER_OBJECT_SYMBOL_DATA)
+            {
+                label_insert(ci, NULL, 0, symbol->name, strlen(symbol->name), data_base[i] + symbol->value, 0);
+            }
+            else if(symbol->kind == COMPILER_OBJECT_SYMBOL_TEXT)
+            {
+                label_insert(ci, NULL, 0, symbol->name, strlen(symbol->name), text_base[i] + symbol->value, 0);
+                if(symbol->frame & COMPILER_OBJECT_SYMBOL_FRAME_RETM)
+                {
+                    frame_insert(ci, symbol->name, strlen(symbol->name), symbol->frame & LA16_CALL_SAVE_ALL);
+                }
+            }
+        }
+    }
+
+    for(unsigned long i = 0; i < object_cnt; i++)
+    {
+        for(unsigned long j = 0; j < object[i].symbol_cnt; j++)
+        {
+            compiler_object_symbol_t *symbol = &object[i].symbol[j];
+            if(symbol->kind == COMPILER_OBJECT_SYMBOL_ABS)
+            {
+                constant_insert(ci, symbol->name, strlen(symbol->name), symbol->value);
+            }
+            else if(symbol->kind == COMPILER_OBJECT_SYMBOL_ALIAS)
+            {
+                unsigned int value = label_lookup(ci, symbol->alias, NULL);
+                if(value == COMPILER_LABEL_NOT_FOUND)
+                {
+                    compiler_error(ci, "lookup: %s not found", symbol->alias);
+                }
+                constant_insert(ci, symbol->name, strlen(symbol->name), value);
+            }
+        }
+    }
+
+    /* relocating and encoding the text */
+    link_ctx_t ctx = {
+        .ci = ci,
+        .object = object,
+        .data_base = data_base,
+        .text_base = text_base,
+    };
+    compiler_parallel_for(ci, object_cnt, link_encode_object, &ctx);
+    ci->image_uaddr = addr;
+
+    /* writing entry point into the header */
+    code_token_label_insert_start(ci);
+}
@@ -22,16 +22,11 @@
  * SOFTWARE.
  */
 
-#ifndef COMPILER_CMPTOK_H
-#define COMPILER_CMPTOK_H
+#ifndef COMPILER_LINK_H
+#define COMPILER_LINK_H
 
-enum CMPTOK_TOKEN_MODE
-{
-    CMPTOK_TOKEN_MODE_NONE      = 0b00,
-    CMPTOK_TOKEN_MODE_DELIMETER = 0b01,
-    CMPTOK_TOKEN_MODE_METER     = 0b10
-};
+#include <compiler/type.h>
 
-const char *cmptok(const char *token);
+void link_objects(compiler_invocation_t *ci, compiler_object_t *object, unsigned long object_cnt);
 
-#endif /* COMPILER_CMPTOK_H */
+#endif /* COMPILER_LINK_H */
@@ -0,0 +1,404 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <compiler/object.h>
+#include <compiler/label.h>
+#include <compiler/frame.h>
+#include <compiler/error.h>
+
+void object_symbol_push(compiler_invocation_t *ci,
+                        const char *name,
+                        unsigned short name_len,
+                        unsigned char kind,
+                        unsigned short value,
+                        const char *alias,
+                        unsigned char frame)
+{
+    compiler_object_t *object = ci->object;
+
+    // Growing symbol array if needed
+    if(object->symbol_cnt >= object->symbol_cap)
+    {
+        unsigned long old_cap = object->symbol_cap;
+        object->symbol_cap = (object->symbol_cap == 0) ? 16 : object->symbol_cap * 2;
+        object->symbol = compiler_arena_realloc(&ci->arena, object->symbol, sizeof(compiler_object_symbol_t) * old_cap, sizeof(compiler_object_symbol_t) * object->symbol_cap);
+    }
+
+    // Symbol names are null terminated copies, the object outlives the tokens on disk
+    char *copy = compiler_arena_alloc(&ci->arena, name_len + 1);
+    memcpy(copy, name, name_len);
+    copy[name_len] = '\0';
+
+    compiler_object_symbol_t *symbol = &object->symbol[object->symbol_cnt++];
+    symbol->name = copy;
+    symbol->kind = kind;
+    symbol->value = value;
+    symbol->alias = alias;
+    symbol->frame = frame;
+}
+
+void object_reloc_reference(compiler_invocation_t *ci,
+                            compiler_arena_t *arena,
+                            const char *parameter,
+                            const compiler_scope_t *scope,
+                            compiler_object_reloc_t *reloc)
+{
+    /* labels of this object are relative to one of its sections */
+    const compiler_label_t *label = label_lookup_label(ci, parameter, scope);
+    if(label != NULL)
+    {
+        reloc->kind = label->rel ? COMPILER_OBJECT_RELOC_TEXT : COMPILER_OBJECT_RELOC_DATA;
+        reloc->addend = label->addr;
+        reloc->name = NULL;
+        return;
+    }
+
+    /* everything else is resolved against the other objects at link time */
+    reloc->kind = COMPILER_OBJECT_RELOC_SYMBOL;
+    reloc->addend = 0;
+    reloc->name = compiler_arena_strdup(arena, parameter);
+}
+
+void object_reloc_collect(compiler_invocation_t *ci,
+                          compiler_object_reloc_t *slot,
+                          unsigned long instr_cnt)
+{
+    compiler_object_t *object = ci->object;
+
+    /* every instruction has a slot per argument, most of them stay empty */
+    unsigned long cnt = 0;
+    for(unsigned long i = 0; i < instr_cnt * 2; i++)
+    {
+        if(slot[i].kind != COMPILER_OBJECT_RELOC_NONE)
+        {
+            cnt++;
+        }
+    }
+
+    object->reloc = compiler_arena_alloc(&ci->arena, sizeof(compiler_object_reloc_t) * cnt);
+    object->reloc_cnt = 0;
+    object->reloc_cap = cnt;
+
+    for(unsigned long i = 0; i < instr_cnt * 2; i++)
+    {
+        if(slot[i].kind != COMPILER_OBJECT_RELOC_NONE)
+        {
+            compiler_object_reloc_t *reloc = &object->reloc[object->reloc_cnt++];
+            *reloc = slot[i];
+            reloc->instr = i / 2;
+            reloc->arg = i % 2;
+        }
+    }
+}
+
+void object_export_labels(compiler_invocation_t *ci)
+{
+    /* scoped labels stay private to the object */
+    for(unsigned long i = 0; i < ci->label_cnt; i++)
+    {
+        compiler_label_t *label = &ci->label[i];
+        if(label->scope == NULL)
+        {
+            /* callers in other objects need to know which functions want blm */
+            unsigned char frame = 0;
+            int mask = frame_lookup(ci, label->name, label->name_len);
+            if(label->rel && mask != COMPILER_FRAME_NOT_FOUND)
+            {
+                frame = COMPILER_OBJECT_SYMBOL_FRAME_RETM | mask;
+            }
+
+            object_symbol_push(ci, label->name, label->name_len, label->rel ? COMPILER_OBJECT_SYMBOL_TEXT : COMPILER_OBJECT_SYMBOL_DATA, label->addr, NULL, frame);
+        }
+    }
+}
+
+char *object_path(compiler_invocation_t *ci,
+                  const char *file)
+{
+    /* foo.l16 becomes foo.o, anything else gets .o appended */
+    size_t len = strlen(file);
+    if(len > 4 && strcmp(file + len - 4, ".l16") == 0)
+    {
+        len -= 4;
+    }
+
+    char *path = compiler_arena_alloc(&ci->arena, len + 3);
+    memcpy(path, file, len);
+    memcpy(path + len, ".o", 3);
+    return path;
+}
+
+static uint32_t object_string_add(char *strtab,
+                                  uint32_t *string_size,
+                                  const char *str)
+{
+    if(str == NULL)
+    {
+        return 0;
+    }
+
+    uint32_t off = *string_size;
+    size_t len = strlen(str) + 1;
+    if(strtab != NULL)
+    {
+        memcpy(strtab + off, str, len);
+    }
+    *string_size += len;
+    return off;
+}
+
+void *object_serialize(compiler_invocation_t *ci,
+                       const compiler_object_t *object,
+                       size_t *size)
+{
+    /* sizing the string table, its first byte is the empty string */
+    uint32_t string_size = 1;
+    for(unsigned long i = 0; i < object->symbol_cnt; i++)
+    {
+        object_string_add(NULL, &string_size, object->symbol[i].name);
+        object_string_add(NULL, &string_size, object->symbol[i].alias);
+    }
+    for(unsigned long i = 0; i < object->reloc_cnt; i++)
+    {
+        object_string_add(NULL, &string_size, object->reloc[i].name);
+    }
+
+    *size = sizeof(compiler_object_header_t) +
+            COMPILER_OBJECT_DATA_PAD(object->data_size) +
+            object->text_cnt * sizeof(compiler_object_instruction_record_t) +
+            object->symbol_cnt * sizeof(compiler_object_symbol_record_t) +
+            object->reloc_cnt * sizeof(compiler_object_reloc_record_t) +
+            string_size;
+
+    unsigned char *buf = compiler_arena_calloc(&ci->arena, 1, *size);
+
+    /* carving the regions out of the buffer */
+    compiler_object_header_t *header = (compiler_object_header_t*)buf;
+    unsigned char *data = buf + sizeof(compiler_object_header_t);
+    compiler_object_instruction_record_t *text = (compiler_object_instruction_record_t*)(data + COMPILER_OBJECT_DATA_PAD(object->data_size));
+    compiler_object_symbol_record_t *symbol = (compiler_object_symbol_record_t*)(text + object->text_cnt);
+    compiler_object_reloc_record_t *reloc = (compiler_object_reloc_record_t*)(symbol + object->symbol_cnt);
+    char *strtab = (char*)(reloc + object->reloc_cnt);
+
+    header->magic = COMPILER_OBJECT_MAGIC;
+    header->version = COMPILER_OBJECT_VERSION;
+    header->data_size = object->data_size;
+    header->text_cnt = object->text_cnt;
+    header->symbol_cnt = object->symbol_cnt;
+    header->reloc_cnt = object->reloc_cnt;
+    header->string_size = string_size;
+
+    memcpy(data, object->data, object->data_size);
+
+    for(unsigned long i = 0; i < object->text_cnt; i++)
+    {
+        text[i].opcode = object->text[i].opcode;
+        text[i].mode = object->text[i].mode;
+        text[i].arg[0] = object->text[i].arg[0];
+        text[i].arg[1] = object->text[i].arg[1];
+        text[i].ext = object->text[i].ext;
+    }
+
+    string_size = 1;
+    for(unsigned long i = 0; i < object->symbol_cnt; i++)
+    {
+        symbol[i].name = object_string_add(strtab, &string_size, object->symbol[i].name);
+        symbol[i].alias = object_string_add(strtab, &string_size, object->symbol[i].alias);
+        symbol[i].value = object->symbol[i].value;
+        symbol[i].kind = object->symbol[i].kind;
+        symbol[i].frame = object->symbol[i].frame;
+    }
+
+    for(unsigned long i = 0; i < object->reloc_cnt; i++)
+    {
+        reloc[i].instr = object->reloc[i].instr;
+        reloc[i].name = object_string_add(strtab, &string_size, object->reloc[i].name);
+        reloc[i].addend = object->reloc[i].addend;
+        reloc[i].arg = object->reloc[i].arg;
+        reloc[i].kind = object->reloc[i].kind;
+    }
+
+    return buf;
+}
+
+static const char *object_string(compiler_invocation_t *ci,
+                                 const char *strtab,
+                                 uint32_t string_size,
+                                 uint32_t off)
+{
+    /* strings have to start inside the table and end inside it */
+    if(off >= string_size || memchr(strtab + off, '\0', string_size - off) == NULL)
+    {
+        compiler_error(ci, "malformed object: string out of bounds");
+    }
+    return (off == 0) ? NULL : strtab + off;
+}
+
+void object_deserialize(compiler_invocation_t *ci,
+                        const void *buf,
+                        size_t size,
+                        compiler_object_t *object)
+{
+    const compiler_object_header_t *header = buf;
+
+    if(size < sizeof(compiler_object_header_t) ||
+       header->magic != COMPILER_OBJECT_MAGIC ||
+       header->version != COMPILER_OBJECT_VERSION)
+    {
+        compiler_error(ci, "malformed object: bad header");
+    }
+
+    /* sizes are checked in a wide type so corrupted counts cannot wrap */
+    unsigned long long needed = sizeof(compiler_object_header_t) +
+                                COMPILER_OBJECT_DATA_PAD((unsigned long long)header->data_size) +
+                                (unsigned long long)header->text_cnt * sizeof(compiler_object_instruction_record_t) +
+                                (unsigned long long)header->symbol_cnt * sizeof(compiler_object_symbol_record_t) +
+                                (unsigned long long)header->reloc_cnt * sizeof(compiler_object_reloc_record_t) +
+                                header->string_size;
+    if(needed != size || header->string_size == 0)
+    {
+        compiler_error(ci, "malformed object: size mismatch");
+    }
+
+    const unsigned char *data = (const unsigned char*)buf + sizeof(compiler_object_header_t);
+    const compiler_object_instruction_record_t *text = (const compiler_object_instruction_record_t*)(data + COMPILER_OBJECT_DATA_PAD(header->data_size));
+    const compiler_object_symbol_record_t *symbol = (const compiler_object_symbol_record_t*)(text + header->text_cnt);
+    const compiler_object_reloc_record_t *reloc = (const compiler_object_reloc_record_t*)(symbol + header->symbol_cnt);
+    const char *strtab = (const char*)(reloc + header->reloc_cnt);
+
+    memset(object, 0, sizeof(compiler_object_t));
+
+    object->data_size = header->data_size;
+    object->data = compiler_arena_alloc(&ci->arena, header->data_size);
+    memcpy(object->data, data, header->data_size);
+
+    object->text_cnt = object->text_cap = header->text_cnt;
+    object->text = compiler_arena_alloc(&ci->arena, sizeof(la16_compiler_instruction_t) * header->text_cnt);
+    for(unsigned long i = 0; i < header->text_cnt; i++)
+    {
+        object->text[i].opcode = text[i].opcode;
+        object->text[i].mode = text[i].mode;
+        object->text[i].arg[0] = text[i].arg[0];
+        object->text[i].arg[1] = text[i].arg[1];
+        object->text[i].ext = text[i].ext;
+    }
+
+    object->symbol_cnt = object->symbol_cap = header->symbol_cnt;
+    object->symbol = compiler_arena_alloc(&ci->arena, sizeof(compiler_object_symbol_t) * header->symbol_cnt);
+    for(unsigned long i = 0; i < header->symbol_cnt; i++)
+    {
+        object->symbol[i].name = object_string(ci, strtab, header->string_size, symbol[i].name);
+        object->symbol[i].alias = object_string(ci, strtab, header->string_size, symbol[i].alias);
+        object->symbol[i].value = symbol[i].value;
+        object->symbol[i].kind = symbol[i].kind;
+        object->symbol[i].frame = symbol[i].frame;
+
+        if(object->symbol[i].name == NULL ||
+           (object->symbol[i].kind == COMPILER_OBJECT_SYMBOL_ALIAS && object->symbol[i].alias == NULL))
+        {
+            compiler_error(ci, "malformed object: unnamed symbol");
+        }
+
+        if(object->symbol[i].frame != 0 &&
+           (object->symbol[i].kind != COMPILER_OBJECT_SYMBOL_TEXT ||
+            (object->symbol[i].frame & ~(COMPILER_OBJECT_SYMBOL_FRAME_RETM | LA16_CALL_SAVE_ALL)) != 0))
+        {
+            compiler_error(ci, "malformed object: illegal call frame");
+        }
+    }
+
+    object->reloc_cnt = object->reloc_cap = header->reloc_cnt;
+    object->reloc = compiler_arena_alloc(&ci->arena, sizeof(compiler_object_reloc_t) * header->reloc_cnt);
+    for(unsigned long i = 0; i < header->reloc_cnt; i++)
+    {
+        object->reloc[i].instr = reloc[i].instr;
+        object->reloc[i].name = object_string(ci, strtab, header->string_size, reloc[i].name);
+        object->reloc[i].addend = reloc[i].addend;
+        object->reloc[i].arg = reloc[i].arg;
+        object->reloc[i].kind = reloc[i].kind;
+
+        if(reloc[i].instr >= header->text_cnt || reloc[i].arg > 1 ||
+           (reloc[i].kind == COMPILER_OBJECT_RELOC_SYMBOL && object->reloc[i].name == NULL))
+        {
+            compiler_error(ci, "malformed object: bad relocation");
+        }
+    }
+}
+
+void object_write(compiler_invocation_t *ci,
+                  const char *path)
+{
+    size_t size = 0;
+    void *buf = object_serialize(ci, ci->object, &size);
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)
+    {
+        compiler_error(ci, "%s: %s", path, strerror(errno));
+    }
+
+    ssize_t bytes = write(fd, buf, size);
+    close(fd);
+
+    if(bytes != (ssize_t)size)
+    {
+        compiler_error(ci, "%s: short write", path);
+    }
+}
+
+void object_read(compiler_invocation_t *ci,
+                 const char *path,
+                 compiler_object_t *object)
+{
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+    {
+        compiler_error(ci, "%s: %s", path, strerror(errno));
+    }
+
+    struct stat fdstat;
+    if(fstat(fd, &fdstat) < 0)
+    {
+        close(fd);
+        compiler_error(ci, "fstat: %s", strerror(errno));
+    }
+
+    void *buf = compiler_arena_alloc(&ci->arena, fdstat.st_size);
+    ssize_t bytes = read(fd, buf, fdstat.st_size);
+    close(fd);
+
+    if(bytes != fdstat.st_size)
+    {
+        compiler_error(ci, "%s: short read", path);
+    }
+
+    object_deserialize(ci, buf, fdstat.st_size, object);
+}
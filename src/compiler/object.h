@@ -0,0 +1,88 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef COMPILER_OBJECT_H
+#define COMPILER_OBJECT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <compiler/type.h>
+
+#define COMPILER_OBJECT_MAGIC       0x4F36314C      /* "L16O" */
+#define COMPILER_OBJECT_VERSION     4
+
+#define COMPILER_OBJECT_DATA_PAD(size)  (((size) + 3) & ~3UL)
+
+/*
+ * On disk layout of a relocatable object, little endian like the boot image
+ *
+ * header, data bytes padded to 4, instructions, symbol records, relocation
+ * records and a string table whose first byte is the empty string
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t data_size;
+    uint32_t text_cnt;
+    uint32_t symbol_cnt;
+    uint32_t reloc_cnt;
+    uint32_t string_size;
+} compiler_object_header_t;
+
+typedef struct {
+    uint8_t opcode;
+    uint8_t mode;
+    uint16_t arg[2];
+    uint16_t ext;
+} compiler_object_instruction_record_t;
+
+typedef struct {
+    uint32_t name;                          /* offset into the string table */
+    uint32_t alias;                         /* offset into the string table, 0 if none */
+    uint16_t value;
+    uint8_t kind;
+    uint8_t frame;                          /* call frame of a function, 0 if it returns with ret */
+} compiler_object_symbol_record_t;
+
+typedef struct {
+    uint32_t instr;
+    uint32_t name;                          /* offset into the string table, 0 if none */
+    uint16_t addend;
+    uint8_t arg;
+    uint8_t kind;
+} compiler_object_reloc_record_t;
+
+void object_symbol_push(compiler_invocation_t *ci, const char *name, unsigned short name_len, unsigned char kind, unsigned short value, const char *alias, unsigned char frame);
+void object_reloc_reference(compiler_invocation_t *ci, compiler_arena_t *arena, const char *parameter, const compiler_scope_t *scope, compiler_object_reloc_t *reloc);
+void object_reloc_collect(compiler_invocation_t *ci, compiler_object_reloc_t *slot, unsigned long instr_cnt);
+void object_export_labels(compiler_invocation_t *ci);
+
+void *object_serialize(compiler_invocation_t *ci, const compiler_object_t *object, size_t *size);
+void object_deserialize(compiler_invocation_t *ci, const void *buf, size_t size, compiler_object_t *object);
+
+char *object_path(compiler_invocation_t *ci, const char *file);
+void object_write(compiler_invocation_t *ci, const char *path);
+void object_read(compiler_invocation_t *ci, const char *path, compiler_object_t *object);
+
+#endif /* COMPILER_OBJECT_H */
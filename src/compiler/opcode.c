@@ -104,6 +104,30 @@ opcode_entry_t opcode_table[LA16_OPCODE_MAX + 1] = {
     { .name = "crtimeset", .opcode = LA16_OPCODE_CRTIMESET },
     { .name = "crctxhndlset", .opcode = LA16_OPCODE_CRCTXHNDLSET },
     { .name = "crexchndlset", .opcode = LA16_OPCODE_CREXCHNDLSET },
+
+    /* masked control flow operations */
+    { .name = "blm", .opcode = LA16_OPCODE_BLM },
+    { .name = "retm", .opcode = LA16_OPCODE_RETM },
+
+    /* compare and branch operations */
+    { .name = "beq", .opcode = LA16_OPCODE_BEQ },
+    { .name = "bne", .opcode = LA16_OPCODE_BNE },
+    { .name = "blt", .opcode = LA16_OPCODE_BLT },
+    { .name = "bgt", .opcode = LA16_OPCODE_BGT },
+    { .name = "ble", .opcode = LA16_OPCODE_BLE },
+    { .name = "bge", .opcode = LA16_OPCODE_BGE },
+
+    /* block memory operations */
+    { .name = "mcpy", .opcode = LA16_OPCODE_MCPY },
+    { .name = "mset", .opcode = LA16_OPCODE_MSET },
+    { .name = "mcmp", .opcode = LA16_OPCODE_MCMP },
+
+    /* idle operations */
+    { .name = "wfi", .opcode = LA16_OPCODE_WFI },
+
+    /* interrupt bank operations */
+    { .name = "bnkget", .opcode = LA16_OPCODE_BNKGET },
+    { .name = "bnkset", .opcode = LA16_OPCODE_BNKSET },
 };
 
 opcode_entry_t *opcode_from_string(const char *name)
@@ -115,7 +139,7 @@ opcode_entry_t *opcode_from_string(const char *name)
     }
 
     /* iterating through table */
-    for(unsigned char opcode = 0x00; opcode < (LA16_OPCODE_MAX - 1); opcode++)
+    for(unsigned char opcode = 0x00; opcode <= LA16_OPCODE_MAX; opcode++)
     {
         /* check if opcode name matches */
         if(strcmp(opcode_table[opcode].name, name) == 0)
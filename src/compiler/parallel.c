@@ -0,0 +1,141 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <compiler/parallel.h>
+#include <compiler/error.h>
+
+typedef struct {
+    compiler_parallel_fn_t fn;
+    void *ctx;
+    unsigned long cnt;
+    atomic_ulong next;                      /* next item a worker picks up */
+    compiler_trap_t *trap;                  /* one trap per item */
+} compiler_parallel_t;
+
+/* set on worker threads, nested loops run on the worker they are called from */
+static _Thread_local bool compiler_parallel_nested = false;
+
+static void *compiler_parallel_worker(void *arg)
+{
+    compiler_parallel_t *par = arg;
+    compiler_trap_t *outer = compiler_trap_set(NULL);
+    bool nested = compiler_parallel_nested;
+    compiler_parallel_nested = true;
+
+    /* picking items till there are none left */
+    unsigned long i;
+    while((i = atomic_fetch_add_explicit(&par->next, 1, memory_order_relaxed)) < par->cnt)
+    {
+        compiler_trap_t *trap = &par->trap[i];
+        compiler_trap_set(trap);
+        if(setjmp(trap->jmp) == 0)
+        {
+            par->fn(par->ctx, i);
+        }
+        compiler_trap_set(NULL);
+    }
+
+    compiler_trap_set(outer);
+    compiler_parallel_nested = nested;
+    return NULL;
+}
+
+void compiler_parallel_for(compiler_invocation_t *ci,
+                           unsigned long cnt,
+                           compiler_parallel_fn_t fn,
+                           void *ctx)
+{
+    if(cnt == 0)
+    {
+        return;
+    }
+
+    compiler_parallel_t par = {
+        .fn = fn,
+        .ctx = ctx,
+        .cnt = cnt,
+        .trap = calloc(cnt, sizeof(compiler_trap_t)),
+    };
+    atomic_init(&par.next, 0);
+
+    if(par.trap == NULL)
+    {
+        compiler_error(ci, "out of memory");
+    }
+
+    /* one thread per online cpu, the calling thread is one of them */
+    long thread_cnt = sysconf(_SC_NPROCESSORS_ONLN);
+    if(thread_cnt < 1)
+    {
+        thread_cnt = 1;
+    }
+    if(thread_cnt > COMPILER_PARALLEL_THREAD_MAX)
+    {
+        thread_cnt = COMPILER_PARALLEL_THREAD_MAX;
+    }
+    if(compiler_parallel_nested)
+    {
+        thread_cnt = 1;
+    }
+    else if((unsigned long)thread_cnt > cnt)
+    {
+        thread_cnt = cnt;
+    }
+
+    pthread_t thread[COMPILER_PARALLEL_THREAD_MAX];
+    long started = 0;
+    for(; started < thread_cnt - 1; started++)
+    {
+        if(pthread_create(&thread[started], NULL, compiler_parallel_worker, &par) != 0)
+        {
+            break;
+        }
+    }
+
+    compiler_parallel_worker(&par);
+
+    for(long i = 0; i < started; i++)
+    {
+        pthread_join(thread[i], NULL);
+    }
+
+    /* reporting the error of the first failed item, so output does not depend on scheduling */
+    for(unsigned long i = 0; i < cnt; i++)
+    {
+        if(par.trap[i].diag.error)
+        {
+            la16_diag_t diag = par.trap[i].diag;
+            free(par.trap);
+            compiler_error(ci, "%s", diag.message);
+        }
+    }
+
+    free(par.trap);
+}
@@ -161,7 +161,7 @@ static bool parse_type_is_char(const char *line, unsigned long *num)
     return true;
 }
 
-static bool parse_type_is_buffer(const char *line, unsigned long *num, unsigned long *blen)
+static bool parse_type_is_buffer(const char *line, unsigned long *num, unsigned long *blen, compiler_arena_t *arena)
 {
     // Must start and end with single quotes
     size_t len = strlen(line);
@@ -170,10 +170,8 @@ static bool parse_type_is_buffer(const char *line, unsigned long *num, unsigned
         return false;
     }
 
-    // Allocate temporary buffer (worst case: no escapes)
-    char *buf = malloc(len - 1);
-    if (!buf)
-        return false;
+    // Allocate buffer from the arena (worst case: no escapes)
+    char *buf = compiler_arena_alloc(arena, len - 1);
 
     size_t out = 0;
     for (size_t i = 1; i < len - 1; i++) {
@@ -181,7 +179,6 @@ static bool parse_type_is_buffer(const char *line, unsigned long *num, unsigned
         if (c == '\\') {
             // Handle escape sequences
             if (i + 1 >= len - 1) {
-                free(buf);
                 return false;
             }
             char esc = line[++i];
@@ -194,7 +191,6 @@ static bool parse_type_is_buffer(const char *line, unsigned long *num, unsigned
                 case '\\': buf[out++] = '\\'; break;
                 case '\'': buf[out++] = '\''; break;
                 default:
-                    free(buf);
                     return false; // Unknown escape
             }
         } else {
@@ -217,7 +213,8 @@ static bool parse_type_is_buffer(const char *line, unsigned long *num, unsigned
  */
 unsigned char parse_type(const char *line,
                          unsigned long *fastdec,
-                         unsigned long *len)
+                         unsigned long *len,
+                         compiler_arena_t *arena)
 {
     if(parse_type_is_hex(line, fastdec))
     {
@@ -235,16 +232,16 @@ unsigned char parse_type(const char *line,
     {
         return PARSE_TYPE_CHAR;
     }
-    else if(parse_type_is_buffer(line, fastdec, len))
+    else if(parse_type_is_buffer(line, fastdec, len, arena))
     {
         return PARSE_TYPE_BUFFER;
     }
     return PARSE_TYPE_STRING;
 }
 
-parse_type_return_t parse_type_lc(const char *line)
+parse_type_return_t parse_type_lc(const char *line, compiler_arena_t *arena)
 {
     parse_type_return_t retval ={};
-    retval.type = parse_type(line, &(retval.value), &(retval.len));
+    retval.type = parse_type(line, &(retval.value), &(retval.len), arena);
     return retval;
 }
@@ -25,6 +25,8 @@
 #ifndef TOKENENGINE_PARSE_H
 #define TOKENENGINE_PARSE_H
 
+#include <compiler/arena.h>
+
 enum PARSE_TYPE
 {
     PARSE_TYPE_STRING    = 0b0001,
@@ -44,6 +46,6 @@ struct parse_type_return
 
 typedef struct parse_type_return parse_type_return_t;
 
-parse_type_return_t parse_type_lc(const char *line);
+parse_type_return_t parse_type_lc(const char *line, compiler_arena_t *arena);
 
 #endif /* TOKENENGINGE_PARSE_H */
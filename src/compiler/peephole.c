@@ -0,0 +1,513 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <compiler/peephole.h>
+#include <compiler/code.h>
+#include <compiler/register.h>
+#include <compiler/parse.h>
+
+#define PEEPHOLE_REG_MAX    7       /* call expansions only ever target r0 to r6 */
+#define PEEPHOLE_CF_SCAN    32      /* instructions looked at to prove cf is dead */
+#define PEEPHOLE_CF_HOPS    4       /* jumps followed to prove cf is dead */
+
+static bool peephole_slice_equal(const compiler_slice_t *a,
+                                 const compiler_slice_t *b)
+{
+    return a->len == b->len && memcmp(a->str, b->str, a->len) == 0;
+}
+
+static bool peephole_is(compiler_invocation_t *ci,
+                        compiler_token_t *ct,
+                        const char *mnemonic)
+{
+    return ct->type == COMPILER_TOKEN_TYPE_ASM &&
+           (ct->flags & COMPILER_TOKEN_FLAG_CALL) &&
+           code_slice_equal(code_token_subtoken(ci, ct, 0), mnemonic);
+}
+
+/* the register push, pop and mov of an expansion operate on */
+static compiler_slice_t *peephole_target(compiler_invocation_t *ci,
+                                         compiler_token_t *ct)
+{
+    return code_token_subtoken(ci, ct, 1);
+}
+
+static bool peephole_reads(compiler_invocation_t *ci,
+                           compiler_token_t *ct,
+                           const compiler_slice_t *reg)
+{
+    if(peephole_is(ci, ct, "mov"))
+    {
+        return peephole_slice_equal(code_token_subtoken(ci, ct, 3), reg);
+    }
+    if(peephole_is(ci, ct, "pop"))
+    {
+        return false;
+    }
+
+    /* push reads its register, bl its target */
+    return peephole_slice_equal(code_token_subtoken(ci, ct, 1), reg);
+}
+
+/*
+ * checks if reg is overwritten by a mov of the call expansion starting
+ * at from before anything reads it, only then its value does not matter
+ */
+static bool peephole_dead_until_mov(compiler_invocation_t *ci,
+                                    unsigned long from,
+                                    const compiler_slice_t *reg)
+{
+    for(unsigned long j = from; j < ci->token_cnt; j++)
+    {
+        compiler_token_t *ct = &ci->token[j];
+        if(ct->type != COMPILER_TOKEN_TYPE_ASM || !(ct->flags & COMPILER_TOKEN_FLAG_CALL))
+        {
+            return false;
+        }
+        if(peephole_reads(ci, ct, reg))
+        {
+            return false;
+        }
+        if(peephole_is(ci, ct, "mov") && peephole_slice_equal(peephole_target(ci, ct), reg))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int peephole_reg_index(const compiler_slice_t *reg)
+{
+    if(reg->len == 2 && reg->str[0] == 'r' && reg->str[1] >= '0' && reg->str[1] < '0' + PEEPHOLE_REG_MAX)
+    {
+        return reg->str[1] - '0';
+    }
+    return -1;
+}
+
+/* bl saves r0 to r24 and ret restores them, every other register may change under a call */
+static bool peephole_preserved(const compiler_slice_t *src)
+{
+    char name[8];
+    if(src->len >= sizeof(name))
+    {
+        return true;
+    }
+    memcpy(name, src->str, src->len);
+    name[src->len] = '\0';
+
+    register_entry_t *reg = register_from_string(name);
+    return reg == NULL || (reg->reg >= LA16_REGISTER_R0 && reg->reg <= LA16_REGISTER_R24);
+}
+
+/*
+ * back to back calls restore a register just to save it again,
+ * pop rN followed by push rN can go if the next expansion
+ * overwrites rN before it reads it
+ */
+static void peephole_pop_push(compiler_invocation_t *ci)
+{
+    unsigned long w = 0;
+    for(unsigned long i = 0; i < ci->token_cnt; i++)
+    {
+        compiler_token_t *ct = &ci->token[i];
+        if(w > 0 &&
+           peephole_is(ci, ct, "push") &&
+           peephole_is(ci, &ci->token[w - 1], "pop") &&
+           peephole_slice_equal(peephole_target(ci, ct), peephole_target(ci, &ci->token[w - 1])) &&
+           peephole_dead_until_mov(ci, i + 1, peephole_target(ci, ct)))
+        {
+            w--;
+            continue;
+        }
+        ci->token[w++] = *ct;
+    }
+    ci->token_cnt = w;
+}
+
+/*
+ * a register that already holds a value, because an earlier
+ * expansion moved it there and the call in between preserved it,
+ * does not need the same mov again
+ */
+static void peephole_mov(compiler_invocation_t *ci)
+{
+    const compiler_slice_t *known[PEEPHOLE_REG_MAX] = {};
+
+    unsigned long w = 0;
+    for(unsigned long i = 0; i < ci->token_cnt; i++)
+    {
+        compiler_token_t *ct = &ci->token[i];
+
+        if(ct->type != COMPILER_TOKEN_TYPE_ASM || !(ct->flags & COMPILER_TOKEN_FLAG_CALL))
+        {
+            /* anything else may write any register or be jumped to */
+            memset(known, 0, sizeof(known));
+        }
+        else if(peephole_is(ci, ct, "mov") || peephole_is(ci, ct, "pop"))
+        {
+            compiler_slice_t *target = peephole_target(ci, ct);
+            int idx = peephole_reg_index(target);
+            const compiler_slice_t *src = peephole_is(ci, ct, "mov") ? code_token_subtoken(ci, ct, 3) : NULL;
+
+            if(src != NULL && idx >= 0 && known[idx] != NULL && peephole_slice_equal(known[idx], src))
+            {
+                continue;
+            }
+
+            /* values read from the written register are stale now */
+            for(int r = 0; r < PEEPHOLE_REG_MAX; r++)
+            {
+                if(known[r] != NULL && peephole_slice_equal(known[r], target))
+                {
+                    known[r] = NULL;
+                }
+            }
+
+            if(idx >= 0)
+            {
+                known[idx] = (src != NULL && peephole_preserved(src)) ? src : NULL;
+            }
+        }
+
+        ci->token[w++] = *ct;
+    }
+    ci->token_cnt = w;
+}
+
+static bool peephole_mnemonic(compiler_invocation_t *ci,
+                              compiler_token_t *ct,
+                              const char **mnemonic)
+{
+    if(ct->type != COMPILER_TOKEN_TYPE_ASM)
+    {
+        return false;
+    }
+
+    compiler_slice_t *op = code_token_subtoken(ci, ct, 0);
+    for(unsigned long i = 0; mnemonic[i] != NULL; i++)
+    {
+        if(code_slice_equal(op, mnemonic[i]))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static const char *peephole_jcc[] = { "je", "jne", "jlt", "jgt", "jle", "jge", NULL };
+static const char *peephole_bcc[] = { "beq", "bne", "blt", "bgt", "ble", "bge", NULL };
+
+/* instructions after which nothing reads the cf a cmp left, ret and intret restore it */
+static const char *peephole_cf_kill[] = { "cmp", "ret", "intret", "hlt", NULL };
+
+/* instructions that read cf or leave the function with it */
+static const char *peephole_cf_use[] = { "je", "jne", "jlt", "jgt", "jle", "jge", "bl", "blm", "int", "retm", NULL };
+
+/* splits the operands of an instruction at the first comma, subtokens keep the commas glued to them */
+static unsigned long peephole_operands(compiler_invocation_t *ci,
+                                       compiler_token_t *ct,
+                                       compiler_slice_t operand[2])
+{
+    if(ct->subtoken_cnt < 2)
+    {
+        return 0;
+    }
+
+    char *operands = code_token_bind(ci, ct, 1);
+    char *comma = strchr(operands, ',');
+    if(comma == NULL)
+    {
+        operand[0] = (compiler_slice_t){ .str = operands, .len = strlen(operands) };
+        return 1;
+    }
+
+    operand[0] = (compiler_slice_t){ .str = operands, .len = (unsigned long)(comma - operands) };
+    operand[1] = (compiler_slice_t){ .str = comma + 1, .len = strlen(comma + 1) };
+    return 2;
+}
+
+/* finds the token of a label of this file, scoped labels are looked up in the scope starting at scope */
+static long peephole_label(compiler_invocation_t *ci,
+                           long scope,
+                           const compiler_slice_t *name)
+{
+    bool scoped = name->len > 0 && name->str[0] == '.';
+    if(scoped && scope < 0)
+    {
+        return -1;
+    }
+
+    for(unsigned long i = scoped ? (unsigned long)scope + 1 : 0; i < ci->token_cnt; i++)
+    {
+        compiler_token_t *ct = &ci->token[i];
+        if(scoped && ct->type == COMPILER_TOKEN_TYPE_LABEL)
+        {
+            return -1;
+        }
+        if(ct->type != (scoped ? COMPILER_TOKEN_TYPE_LABEL_SCOPED : COMPILER_TOKEN_TYPE_LABEL))
+        {
+            continue;
+        }
+
+        /* label tokens keep their trailing ':' */
+        compiler_slice_t *label = code_token_subtoken(ci, ct, 0);
+        if(label->len == name->len + 1 && memcmp(label->str, name->str, name->len) == 0)
+        {
+            return (long)i;
+        }
+    }
+    return -1;
+}
+
+/* checks if the cf a cmp leaves is overwritten or dropped on every path starting at from */
+static bool peephole_cf_dead(compiler_invocation_t *ci,
+                             const bool *drop,
+                             unsigned long from,
+                             long scope,
+                             int hops)
+{
+    unsigned long scanned = 0;
+    for(unsigned long i = from; i < ci->token_cnt && scanned < PEEPHOLE_CF_SCAN; i++)
+    {
+        compiler_token_t *ct = &ci->token[i];
+        if(ct->type == COMPILER_TOKEN_TYPE_LABEL)
+        {
+            scope = (long)i;
+            continue;
+        }
+        if(ct->type == COMPILER_TOKEN_TYPE_LABEL_SCOPED || drop[i])
+        {
+            continue;
+        }
+        if(ct->type != COMPILER_TOKEN_TYPE_ASM || peephole_mnemonic(ci, ct, peephole_cf_use))
+        {
+            return false;
+        }
+
+        /* reading cf or writing pc directly, nothing to reason about */
+        compiler_slice_t operand[2];
+        unsigned long operand_cnt = peephole_operands(ci, ct, operand);
+        for(unsigned long o = 0; o < operand_cnt; o++)
+        {
+            if(code_slice_equal(&operand[o], "cf") || code_slice_equal(&operand[o], "pc"))
+            {
+                return false;
+            }
+        }
+
+        if(peephole_mnemonic(ci, ct, peephole_cf_kill))
+        {
+            return true;
+        }
+        if(peephole_mnemonic(ci, ct, peephole_bcc))
+        {
+            /* compare and branch leaves cf alone, its target has to be fine too */
+            const char *comma = (operand_cnt == 2) ? strrchr(operand[1].str, ',') : NULL;
+            if(comma == NULL || hops == 0)
+            {
+                return false;
+            }
+
+            compiler_slice_t target_name = { .str = comma + 1, .len = strlen(comma + 1) };
+            long target = peephole_label(ci, scope, &target_name);
+            if(target < 0)
+            {
+                return false;
+            }
+
+            /* jumping back into what this scan already went through adds no new path */
+            long target_scope = (ci->token[target].type == COMPILER_TOKEN_TYPE_LABEL) ? target : scope;
+            if(((unsigned long)target < from || (unsigned long)target > i) &&
+               !peephole_cf_dead(ci, drop, (unsigned long)target + 1, target_scope, hops - 1))
+            {
+                return false;
+            }
+        }
+        else if(code_slice_equal(code_token_subtoken(ci, ct, 0), "jmp"))
+        {
+            long target = (ct->subtoken_cnt == 2 && hops > 0) ? peephole_label(ci, scope, code_token_subtoken(ci, ct, 1)) : -1;
+            if(target < 0)
+            {
+                return false;
+            }
+            long target_scope = (ci->token[target].type == COMPILER_TOKEN_TYPE_LABEL) ? target : scope;
+            return peephole_cf_dead(ci, drop, (unsigned long)target + 1, target_scope, hops - 1);
+        }
+        scanned++;
+    }
+    return false;
+}
+
+static bool peephole_register(compiler_invocation_t *ci,
+                              const compiler_slice_t *slice)
+{
+    char name[8];
+    if(slice->len >= sizeof(name))
+    {
+        return false;
+    }
+    code_slice_copy(ci, slice, name, sizeof(name));
+
+    register_entry_t *reg = register_from_string(name);
+    return reg != NULL && reg->reg != LA16_REGISTER_PC && reg->reg != LA16_REGISTER_CF;
+}
+
+static bool peephole_imm8(compiler_invocation_t *ci,
+                          const compiler_slice_t *slice)
+{
+    char value[64];
+    if(slice->len >= sizeof(value))
+    {
+        return false;
+    }
+    code_slice_copy(ci, slice, value, sizeof(value));
+
+    parse_type_return_t pr = parse_type_lc(value, &ci->arena);
+    return (pr.type == PARSE_TYPE_NUMBER ||
+            pr.type == PARSE_TYPE_HEX ||
+            pr.type == PARSE_TYPE_BIN ||
+            pr.type == PARSE_TYPE_CHAR) && pr.value <= 0xFF;
+}
+
+/*
+ * cmp followed by a conditional jump becomes one compare and branch
+ * when the target is close enough and nothing reads cf afterwards,
+ * neither on the way through nor at the target
+ */
+static void peephole_branch(compiler_invocation_t *ci)
+{
+    /* fusing in place first, label and cf lookups index the tokens */
+    bool *drop = compiler_arena_calloc(&ci->arena, ci->token_cnt, sizeof(bool));
+
+    long scope = -1;
+    for(unsigned long i = 0; i + 1 < ci->token_cnt; i++)
+    {
+        compiler_token_t *ct = &ci->token[i];
+        compiler_token_t *jcc = &ci->token[i + 1];
+        if(ct->type == COMPILER_TOKEN_TYPE_LABEL)
+        {
+            scope = (long)i;
+        }
+
+        compiler_slice_t operand[2];
+        if(ct->type != COMPILER_TOKEN_TYPE_ASM ||
+           jcc->subtoken_cnt != 2 ||
+           !code_slice_equal(code_token_subtoken(ci, ct, 0), "cmp") ||
+           !peephole_mnemonic(ci, jcc, peephole_jcc) ||
+           peephole_operands(ci, ct, operand) != 2)
+        {
+            continue;
+        }
+
+        compiler_slice_t a = operand[0];
+        compiler_slice_t b = operand[1];
+        compiler_slice_t target = *code_token_subtoken(ci, jcc, 1);
+        bool imm = !peephole_register(ci, &b);
+        long label = peephole_label(ci, scope, &target);
+
+        if(!peephole_register(ci, &a) ||
+           (imm && !peephole_imm8(ci, &b)) ||
+           label < 0)
+        {
+            continue;
+        }
+
+        /* distances only shrink when jumps go away, the current layout is the worst case */
+        long offset = ((long)ci->token[label].addr - (long)ct->addr) / 4;
+        if(offset < (imm ? LA16_BRANCH_OFFSET8_MIN : LA16_BRANCH_OFFSET_MIN) ||
+           offset > (imm ? LA16_BRANCH_OFFSET8_MAX : LA16_BRANCH_OFFSET_MAX))
+        {
+            continue;
+        }
+
+        long target_scope = (ci->token[label].type == COMPILER_TOKEN_TYPE_LABEL) ? label : scope;
+        if(!peephole_cf_dead(ci, drop, i + 2, scope, PEEPHOLE_CF_HOPS) ||
+           !peephole_cf_dead(ci, drop, (unsigned long)label + 1, target_scope, PEEPHOLE_CF_HOPS))
+        {
+            continue;
+        }
+
+        /* je becomes beq and so on, both tables share their order */
+        unsigned long cc = 0;
+        while(!code_slice_equal(code_token_subtoken(ci, jcc, 0), peephole_jcc[cc]))
+        {
+            cc++;
+        }
+
+        ct->subtoken = ci->subtoken_cnt;
+        ct->subtoken_cnt = 0;
+        code_subtoken_push(ci, ct, peephole_bcc[cc], strlen(peephole_bcc[cc]));
+        code_subtoken_push(ci, ct, a.str, a.len);
+        code_subtoken_push(ci, ct, ",", 1);
+        code_subtoken_push(ci, ct, b.str, b.len);
+        code_subtoken_push(ci, ct, ",", 1);
+        code_subtoken_push(ci, ct, target.str, target.len);
+
+        drop[i + 1] = true;
+        i++;
+    }
+
+    unsigned long w = 0;
+    for(unsigned long i = 0; i < ci->token_cnt; i++)
+    {
+        if(!drop[i])
+        {
+            ci->token[w++] = ci->token[i];
+        }
+    }
+    ci->token_cnt = w;
+}
+
+/* laying the addresses out again, labels point at the instruction after them */
+static void peephole_layout(compiler_invocation_t *ci)
+{
+    unsigned short addr = 0;
+    for(unsigned long i = 0; i < ci->token_cnt; i++)
+    {
+        compiler_token_t *ct = &ci->token[i];
+        if(ct->type == COMPILER_TOKEN_TYPE_LABEL || ct->type == COMPILER_TOKEN_TYPE_LABEL_SCOPED)
+        {
+            ct->addr = addr;
+        }
+        else if(ct->type == COMPILER_TOKEN_TYPE_ASM)
+        {
+            ct->addr = addr;
+            addr += 4;
+        }
+    }
+}
+
+void code_token_peephole(compiler_invocation_t *ci)
+{
+    peephole_pop_push(ci);
+    peephole_mov(ci);
+    peephole_layout(ci);
+
+    peephole_branch(ci);
+    peephole_layout(ci);
+}
@@ -30,6 +30,8 @@
 #include <la16/memory.h>
 #include <compiler/parse.h>
 #include <compiler/code.h>
+#include <compiler/label.h>
+#include <compiler/error.h>
 
 static char *trim(char *str)
 {
@@ -66,7 +68,7 @@ static char *trim(char *str)
     return str;
 }
 
-static char **parse_csv_quoted(const char *input, unsigned long *count)
+static char **parse_csv_quoted(compiler_arena_t *arena, const char *input, unsigned long *count)
 {
     /* null pointer check */
     if(input == NULL || count == NULL)
@@ -75,7 +77,7 @@ static char **parse_csv_quoted(const char *input, unsigned long *count)
     }
 
     /* duplicate input */
-    char *token = strdup(input);
+    char *token = compiler_arena_strdup(arena, input);
     
     unsigned long chain_cnt = 0;
     char *ptr = token;
@@ -97,10 +99,8 @@ static char **parse_csv_quoted(const char *input, unsigned long *count)
     chain_cnt++;
 
     /* allocating chain */
-    char **chain = calloc(chain_cnt, sizeof(char*));
+    char **chain = compiler_arena_calloc(arena, chain_cnt, sizeof(char*));
 
-    free(token);
-    token = strdup(input);
     ptr = token;
     in_quotes = 0;
     char *start = ptr;
@@ -116,17 +116,16 @@ static char **parse_csv_quoted(const char *input, unsigned long *count)
         else if(*ptr == ',' && !in_quotes)
         {
             *ptr = '\0';
-            chain[chain_cnt++] = strdup(trim(start));
+            chain[chain_cnt++] = trim(start);
             start = ptr + 1;
         }
         ptr++;
     }
     if(start <= ptr)
     {
-        chain[chain_cnt++] = strdup(trim(start));
+        chain[chain_cnt++] = trim(start);
     }
 
-    free(token);
     *count = chain_cnt;
     return chain;
 }
@@ -138,67 +137,60 @@ void code_token_section(compiler_invocation_t *ci)
     {
         if(ci->token[i].type == COMPILER_TOKEN_TYPE_SECTION)
         {
-            if(strcmp(ci->token[i].subtoken[1], ".data") == 0)
+            if(code_slice_equal(code_token_subtoken(ci, &ci->token[i], 1), ".data"))
             {
                 /* iterating till section data is over */
                 i++;
                 for(; i < ci->token_cnt && ci->token[i].type == COMPILER_TOKEN_TYPE_SECTION_DATA; i++)
                 {
                     /* inserting address as label */
-                    ci->label_cnt++;
-                    ci->label = realloc(ci->label, sizeof(compiler_label_t) * ci->label_cnt);
-                    ci->label[ci->label_cnt - 1].name = strdup(ci->token[i].subtoken[0]);
-                    ci->label[ci->label_cnt - 1].addr = ci->image_uaddr;
-                    ci->label[ci->label_cnt - 1].rel = 0;
+                    compiler_slice_t *name = code_token_subtoken(ci, &ci->token[i], 0);
+                    label_insert(ci, NULL, 0, name->str, name->len, ci->image_uaddr, 0);
 
                     /* checking if its known */
                     int is_word = 0;
-                    if(strcmp(ci->token[i].subtoken[1], "dw") == 0)
+                    compiler_slice_t *type = code_token_subtoken(ci, &ci->token[i], 1);
+                    if(code_slice_equal(type, "dw"))
                     {
                         is_word = 1;
                     }
-                    else if(strcmp(ci->token[i].subtoken[1], "db") != 0)
+                    else if(!code_slice_equal(type, "db"))
                     {
-                        printf("[!] %s is not a valid data type for .data sections\n", ci->token[i].subtoken[1]);
-                        exit(1);
+                        compiler_error(ci, "%.*s is not a valid data type for .data sections", (int)type->len, type->str);
                     }
 
                     /* binding token at a certain position by its subtokens */
                     unsigned long chain_cnt = 0;
-                    char *chain_str = code_token_bind(&ci->token[i], 2);
+                    char *chain_str = code_token_bind(ci, &ci->token[i], 2);
 
                     /* null pointer check */
                     if(chain_str == NULL)
                     {
-                        printf("[!] null pointer exception\n");
-                        exit(1);
+                        compiler_error(ci, "null pointer exception");
                     }
 
                     /* getting chain */
-                    char **chain = parse_csv_quoted(chain_str, &chain_cnt);
+                    char **chain = parse_csv_quoted(&ci->arena, chain_str, &chain_cnt);
 
                     /* null pointer check */
                     if(chain == NULL)
                     {
-                        printf("[!] null pointer exception\n");
-                        exit(1);
+                        compiler_error(ci, "null pointer exception");
                     }
 
-                    /* freeing bound chain string buffer */
-                    free(chain_str);
-
                     /* iterating through the chain */
                     for(unsigned long a = 0; a < chain_cnt; a++)
                     {
                         /* using low level type parser */
-                        parse_type_return_t pr = parse_type_lc(chain[a]);
+                        parse_type_return_t pr = parse_type_lc(chain[a], &ci->arena);
 
                         /* checking type */
                         if(pr.type == PARSE_TYPE_BUFFER)
                         {
                             /* its a buffer so we copy the buffer into section */
                             char *buffer = (char*)pr.value;
-                            for(unsigned short j = 0; j < pr.len; j++)
+                            code_image_reserve(ci, ci->image_uaddr + pr.len);
+                            for(unsigned long j = 0; j < pr.len; j++)
                             {
                                 ci->image[ci->image_uaddr + j] = (unsigned char)buffer[j];
                             }
@@ -207,6 +199,7 @@ void code_token_section(compiler_invocation_t *ci)
                         else
                         {
                             /* storing value */
+                            code_image_reserve(ci, ci->image_uaddr + (is_word ? 2 : 1));
                             if(is_word)
                             {
                                 ci->image[ci->image_uaddr] = pr.value & 0xFF;
@@ -219,27 +212,25 @@ void code_token_section(compiler_invocation_t *ci)
                                 ci->image_uaddr++;
                             }
                         }
-                        free(chain[a]);
                     }
-                    free(chain);
                 }
                 i--;
             }
-            else if(strcmp(ci->token[i].subtoken[1], ".bss") == 0)
+            else if(code_slice_equal(code_token_subtoken(ci, &ci->token[i], 1), ".bss"))
             {
                 /* finding variable type */
                 i++;
                 for(; i < ci->token_cnt && ci->token[i].type == COMPILER_TOKEN_TYPE_SECTION_DATA; i++)
                 {
                     /* insert label into label array */
-                    ci->label_cnt++;
-                    ci->label = realloc(ci->label, sizeof(compiler_label_t) * ci->label_cnt);
-                    ci->label[ci->label_cnt - 1].name = strdup(ci->token[i].subtoken[0]);
-                    ci->label[ci->label_cnt - 1].addr = ci->image_uaddr;
-                    ci->label[ci->label_cnt - 1].rel = 0;
+                    compiler_slice_t *name = code_token_subtoken(ci, &ci->token[i], 0);
+                    label_insert(ci, NULL, 0, name->str, name->len, ci->image_uaddr, 0);
 
                     /* offset image address by value */
-                    parse_type_return_t pr = parse_type_lc(ci->token[i].subtoken[1]);
+                    char size[256];
+                    code_slice_copy(ci, code_token_subtoken(ci, &ci->token[i], 1), size, sizeof(size));
+                    parse_type_return_t pr = parse_type_lc(size, &ci->arena);
+                    code_image_reserve(ci, ci->image_uaddr + pr.value);
                     ci->image_uaddr += pr.value;
                 }
                 i--;
@@ -247,6 +238,13 @@ void code_token_section(compiler_invocation_t *ci)
         }
     }
 
+    /* relocatable output keeps its data region unaligned, the linker packs them */
+    if(ci->object != NULL)
+    {
+        ci->object->data = ci->image;
+        ci->object->data_size = ci->image_uaddr;
+    }
+
     /* align by 4 */
     ci->image_uaddr = (ci->image_uaddr + 3) & ~0x3;
     ci->image_text_start = ci->image_uaddr;
@@ -0,0 +1,134 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <compiler/symtab.h>
+
+/*
+ * FNV-1a, hashing is a left fold over the bytes so hashing
+ * a scoped name can continue from the precomputed hash of
+ * its scope instead of concatenating both names
+ */
+unsigned int compiler_symtab_hash(const char *str,
+                                  size_t len,
+                                  unsigned int seed)
+{
+    unsigned int hash = seed;
+    for(size_t i = 0; i < len; i++)
+    {
+        hash ^= (unsigned char)str[i];
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
+static void compiler_symtab_place(compiler_symtab_t *st,
+                                  unsigned int hash,
+                                  unsigned long idx)
+{
+    /* linear probing till we find a free slot */
+    unsigned long pos = hash & (st->cap - 1);
+    while(st->slot[pos].idx != 0)
+    {
+        pos = (pos + 1) & (st->cap - 1);
+    }
+
+    /* slot index is biased by one, so zero marks a free slot */
+    st->slot[pos].hash = hash;
+    st->slot[pos].idx = idx + 1;
+}
+
+static void compiler_symtab_grow(compiler_symtab_t *st)
+{
+    compiler_symtab_slot_t *old_slot = st->slot;
+    unsigned long old_cap = st->cap;
+
+    /* doubling the slot array, the old one is released with the arena */
+    st->cap = (old_cap == 0) ? 16 : old_cap * 2;
+    st->slot = compiler_arena_calloc(st->arena, st->cap, sizeof(compiler_symtab_slot_t));
+
+    /* rehashing all occupied slots */
+    for(unsigned long i = 0; i < old_cap; i++)
+    {
+        if(old_slot[i].idx != 0)
+        {
+            compiler_symtab_place(st, old_slot[i].hash, old_slot[i].idx - 1);
+        }
+    }
+}
+
+void compiler_symtab_init(compiler_symtab_t *st,
+                          compiler_arena_t *arena,
+                          unsigned long cnt)
+{
+    st->arena = arena;
+    st->slot = NULL;
+    st->cap = 0;
+    st->cnt = 0;
+
+    /* sizing the table so cnt entries stay below half load */
+    while(st->cap < cnt * 2 || st->cap == 0)
+    {
+        compiler_symtab_grow(st);
+    }
+}
+
+void compiler_symtab_insert(compiler_symtab_t *st,
+                            unsigned int hash,
+                            unsigned long idx)
+{
+    /* keeping the load factor at or below one half */
+    if((st->cnt + 1) * 2 > st->cap)
+    {
+        compiler_symtab_grow(st);
+    }
+
+    compiler_symtab_place(st, hash, idx);
+    st->cnt++;
+}
+
+/*
+ * returns the next array index whose hash matches, the caller
+ * compares the actual names, pos has to start at hash
+ */
+unsigned long compiler_symtab_probe(compiler_symtab_t *st,
+                                    unsigned int hash,
+                                    unsigned long *pos)
+{
+    /* empty table has nothing to probe */
+    if(st->cap == 0)
+    {
+        return COMPILER_SYMTAB_NOT_FOUND;
+    }
+
+    for(unsigned long i = *pos & (st->cap - 1); st->slot[i].idx != 0; i = (i + 1) & (st->cap - 1))
+    {
+        if(st->slot[i].hash == hash)
+        {
+            *pos = i + 1;
+            return st->slot[i].idx - 1;
+        }
+    }
+
+    return COMPILER_SYMTAB_NOT_FOUND;
+}
@@ -0,0 +1,40 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef COMPILER_SYMTAB_H
+#define COMPILER_SYMTAB_H
+
+#include <stddef.h>
+#include <compiler/type.h>
+
+#define COMPILER_SYMTAB_HASH_SEED   0x811C9DC5
+#define COMPILER_SYMTAB_NOT_FOUND   ((unsigned long)-1)
+
+unsigned int compiler_symtab_hash(const char *str, size_t len, unsigned int seed);
+
+void compiler_symtab_init(compiler_symtab_t *st, compiler_arena_t *arena, unsigned long cnt);
+void compiler_symtab_insert(compiler_symtab_t *st, unsigned int hash, unsigned long idx);
+unsigned long compiler_symtab_probe(compiler_symtab_t *st, unsigned int hash, unsigned long *pos);
+
+#endif /* COMPILER_SYMTAB_H */
@@ -25,6 +25,11 @@
 #ifndef COMPILER_TYPE_H
 #define COMPILER_TYPE_H
 
+#include <setjmp.h>
+#include <stdbool.h>
+#include <compiler/arena.h>
+#include <compiler/diag.h>
+
 #define COMPILER_TOKEN_TYPE_ASM             0b000
 #define COMPILER_TOKEN_TYPE_LABEL           0b001
 #define COMPILER_TOKEN_TYPE_SECTION         0b010
@@ -32,6 +37,10 @@
 #define COMPILER_TOKEN_TYPE_LABEL_SCOPED    0b100
 #define COMPILER_TOKEN_TYPE_CONSTANT        0b101
 
+#define COMPILER_TOKEN_FLAG_CALL            0b1     /* emitted by a call expansion */
+
+#define COMPILER_IMAGE_MAX                  0xFFFF  /* boot images have to fit the machines memory */
+
 #define LA16_CODING_NONE                    0b00
 #define LA16_CODING_REG                     0b01
 #define LA16_CODING_IMM                     0b10
@@ -41,40 +50,134 @@ typedef struct {
     unsigned char opcode;
     unsigned char mode;
     unsigned short arg[2];
+    unsigned short ext;                     /* bits past the parameters, memory operands and branch offsets */
 } la16_compiler_instruction_t;
 
 typedef unsigned char compiler_token_type_t;
 
+typedef struct {
+    const char *str;                        /* start of the slice, not null terminated */
+    unsigned long len;                      /* length of the slice */
+} compiler_slice_t;
+
 typedef struct {
     compiler_token_type_t type;
+    unsigned char flags;
     unsigned short addr;
-    char *token;
-    char **subtoken;
-    unsigned long subtoken_cnt;
+    compiler_slice_t token;                 /* whole line the token was lexed from */
+    unsigned long subtoken;                 /* index of the first subtoken in the subtoken array */
+    unsigned long subtoken_cnt;             /* count of subtokens */
 } compiler_token_t;
 
 typedef struct {
-    char *name;
+    const char *scope;                      /* name of the scope label, NULL if unscoped */
+    const char *name;                       /* name of the label */
+    unsigned short scope_len;               /* length of the scope label name */
+    unsigned short name_len;                /* length of the label name */
     unsigned short addr;
     unsigned char rel;
 } compiler_label_t;
 
 typedef struct {
-    char *name;
+    const char *name;
+    unsigned short name_len;
     unsigned short value;
 } compiler_constant_t;
 
 typedef struct {
+    const char *name;                       /* name of the function label */
+    unsigned short name_len;                /* length of the function label name */
+    unsigned char mask;                     /* register groups the function changes */
+} compiler_frame_t;
+
+typedef struct {
+    const char *name;                       /* name of the scope label */
+    unsigned short len;                     /* length of the scope label name */
+    unsigned int hash;                      /* precomputed hash of the scope label name */
+} compiler_scope_t;
+
+typedef struct {
+    unsigned int hash;                      /* hash of the symbol name */
+    unsigned long idx;                      /* index into the symbol array plus one, zero if free */
+} compiler_symtab_slot_t;
+
+typedef struct {
+    compiler_arena_t *arena;                /* arena the slot array is allocated from */
+    compiler_symtab_slot_t *slot;           /* open addressed slot array */
+    unsigned long cap;                      /* count of slots, always a power of two */
+    unsigned long cnt;                      /* count of occupied slots */
+} compiler_symtab_t;
+
+#define COMPILER_OBJECT_RELOC_DATA          0b00
+#define COMPILER_OBJECT_RELOC_TEXT          0b01
+#define COMPILER_OBJECT_RELOC_SYMBOL        0b10
+#define COMPILER_OBJECT_RELOC_NONE          0b11
+
+#define COMPILER_OBJECT_SYMBOL_DATA         0b00
+#define COMPILER_OBJECT_SYMBOL_TEXT         0b01
+#define COMPILER_OBJECT_SYMBOL_ABS          0b10
+#define COMPILER_OBJECT_SYMBOL_ALIAS        0b11
+
+#define COMPILER_OBJECT_SYMBOL_FRAME_RETM   0b100000    /* function returns with retm, the low bits are its save mask */
+
+typedef struct {
+    unsigned long instr;                    /* index of the instruction in the text */
+    unsigned char arg;                      /* argument of the instruction to patch */
+    unsigned char kind;                     /* section relative or symbol reference */
+    unsigned short addend;                  /* offset into the section for section relative relocations */
+    const char *name;                       /* referenced symbol for symbol relocations */
+} compiler_object_reloc_t;
+
+typedef struct {
+    const char *name;                       /* name of the symbol */
+    unsigned char kind;                     /* section, absolute value or alias of a label */
+    unsigned short value;                   /* section offset or absolute value */
+    const char *alias;                      /* label an alias symbol refers to */
+    unsigned char frame;                    /* call frame of a function, zero if it returns with ret */
+} compiler_object_symbol_t;
+
+typedef struct {
+    unsigned char *data;                    /* bytes of the data region */
+    unsigned short data_size;               /* size of the data region */
+    la16_compiler_instruction_t *text;      /* decomposed instructions of the text region */
+    unsigned long text_cnt;                 /* count of instructions */
+    unsigned long text_cap;                 /* capacity of the instruction array */
+    compiler_object_symbol_t *symbol;       /* exported symbols */
+    unsigned long symbol_cnt;               /* count of symbols */
+    unsigned long symbol_cap;               /* capacity of the symbol array */
+    compiler_object_reloc_t *reloc;         /* relocations of the text region */
+    unsigned long reloc_cnt;                /* count of relocations */
+    unsigned long reloc_cap;                /* capacity of the relocation array */
+} compiler_object_t;
+
+typedef struct {
+    compiler_arena_t arena;                 /* arena all allocations of the invocation come from */
+    jmp_buf *fail;                          /* where errors unwind to, NULL to exit the process */
+    la16_diag_t *diag;                      /* diagnostics of in process invocations, may be NULL */
+    compiler_object_t *object;              /* relocatable output, NULL when assembling a boot image */
+    bool optimize;                          /* running the peephole pass over call expansions */
     char *code;                             /* raw code */
-    unsigned long scope_label_idx;          /* current index of the scope label */
     compiler_token_t *token;                /* token array */
     unsigned long token_cnt;                /* count of tokens */
+    unsigned long token_cap;                /* capacity of the token array */
+    compiler_slice_t *subtoken;             /* subtoken array shared by all tokens */
+    unsigned long subtoken_cnt;             /* count of subtokens */
+    unsigned long subtoken_cap;             /* capacity of the subtoken array */
     compiler_label_t *label;                /* label array */
     unsigned long label_cnt;                /* count of labels */
+    unsigned long label_cap;                /* capacity of the label array */
+    compiler_symtab_t label_symtab;         /* hash index over the label array */
     compiler_constant_t *constant;          /* constant array */
     unsigned long constant_cnt;             /* count of constants */
-    unsigned char image[0xFFFF];            /* compiled image */
-    unsigned short image_uaddr;             /* address marker for compiled image */
+    unsigned long constant_cap;             /* capacity of the constant array */
+    compiler_symtab_t constant_symtab;      /* hash index over the constant array */
+    compiler_frame_t *frame;                /* functions returning with retm */
+    unsigned long frame_cnt;                /* count of frames */
+    unsigned long frame_cap;                /* capacity of the frame array */
+    compiler_symtab_t frame_symtab;         /* hash index over the frame array */
+    unsigned char *image;                   /* compiled image, grown by code_image_reserve */
+    unsigned long image_cap;                /* capacity of the image buffer */
+    unsigned long image_uaddr;              /* address marker for compiled image */
     unsigned short image_text_start;        /* start of the images text region */
 } compiler_invocation_t;
 
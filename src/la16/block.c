@@ -0,0 +1,247 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <la16/block.h>
+#include <la16/machine.h>
+#include <la16/instruction/data.h>
+
+static void *la16_block_worker(void *arg)
+{
+    la16_block_t *block = arg;
+
+    pthread_mutex_lock(&block->lock);
+    while(1)
+    {
+        while(block->cmd == 0 && !block->stop)
+        {
+            pthread_cond_wait(&block->cond, &block->lock);
+        }
+        if(block->stop)
+        {
+            break;
+        }
+
+        // Copying straight between the mapping and guest memory
+        unsigned char *sector = &block->map[(size_t)block->cmd_sector * LA16_BLOCK_SECTOR_SIZE];
+        unsigned char *memory = &block->machine->memory->memory[block->cmd_addr];
+        if(block->cmd == LA16_BLOCK_CMD_READ)
+        {
+            memcpy(memory, sector, LA16_BLOCK_SECTOR_SIZE);
+        }
+        else
+        {
+            memcpy(sector, memory, LA16_BLOCK_SECTOR_SIZE);
+        }
+
+        la16_core_t core = block->cmd_core;
+        block->cmd = 0;
+        block->status &= ~LA16_BLOCK_STATUS_BUSY;
+
+        pthread_mutex_unlock(&block->lock);
+        la16_core_raise(core, LA16_INT_BLOCK);
+        pthread_mutex_lock(&block->lock);
+    }
+    pthread_mutex_unlock(&block->lock);
+
+    return NULL;
+}
+
+la16_block_t *la16_block_alloc(la16_machine_t *machine,
+                               const char *path)
+{
+    /* open the backing file */
+    int fd = open(path, O_RDWR);
+    if(fd == -1)
+    {
+        return NULL;
+    }
+
+    /* only whole sectors are reachable */
+    struct stat st;
+    if(fstat(fd, &st) == -1 || st.st_size < LA16_BLOCK_SECTOR_SIZE)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    size_t sector_cnt = st.st_size / LA16_BLOCK_SECTOR_SIZE;
+    if(sector_cnt > LA16_BLOCK_SECTOR_MAX)
+    {
+        sector_cnt = LA16_BLOCK_SECTOR_MAX;
+    }
+
+    size_t map_size = sector_cnt * LA16_BLOCK_SECTOR_SIZE;
+    unsigned char *map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    la16_block_t *block = calloc(1, sizeof(la16_block_t));
+    pthread_mutex_init(&block->lock, NULL);
+    pthread_cond_init(&block->cond, NULL);
+    block->map = map;
+    block->map_size = map_size;
+    block->sector_cnt = (unsigned short)sector_cnt;
+    block->machine = machine;
+
+    pthread_create(&block->worker, NULL, la16_block_worker, block);
+
+    return block;
+}
+
+void la16_block_dealloc(la16_block_t *block)
+{
+    pthread_mutex_lock(&block->lock);
+    block->stop = 1;
+    pthread_cond_signal(&block->cond);
+    pthread_mutex_unlock(&block->lock);
+    pthread_join(block->worker, NULL);
+
+    /* writing back what the guest stored */
+    msync(block->map, block->map_size, MS_SYNC);
+    munmap(block->map, block->map_size);
+
+    pthread_cond_destroy(&block->cond);
+    pthread_mutex_destroy(&block->lock);
+    free(block);
+}
+
+static void la16_block_command(la16_block_t *block,
+                               la16_core_t core,
+                               unsigned short cmd)
+{
+    /* one command at a time, on a sector that exists, into memory that exists */
+    if((block->status & LA16_BLOCK_STATUS_BUSY) ||
+       (cmd != LA16_BLOCK_CMD_READ && cmd != LA16_BLOCK_CMD_WRITE) ||
+       block->sector >= block->sector_cnt ||
+       (unsigned long)block->addr + LA16_BLOCK_SECTOR_SIZE > block->machine->memory->memory_size)
+    {
+        block->status |= LA16_BLOCK_STATUS_ERROR;
+        return;
+    }
+
+    block->cmd = cmd;
+    block->cmd_sector = block->sector;
+    block->cmd_addr = block->addr;
+    block->cmd_core = core;
+    block->status = LA16_BLOCK_STATUS_BUSY;
+    pthread_cond_signal(&block->cond);
+}
+
+static void la16_block_port_in(void *device,
+                               la16_core_t core,
+                               unsigned short port,
+                               unsigned short *val)
+{
+    la16_block_t *block = device;
+
+    pthread_mutex_lock(&block->lock);
+    switch(port)
+    {
+        case LA16_IO_PORT_BLOCK_SECTOR:
+            *val = block->sector;
+            break;
+        case LA16_IO_PORT_BLOCK_ADDR:
+            *val = block->addr;
+            break;
+        case LA16_IO_PORT_BLOCK_CMD:
+            *val = block->status;
+            break;
+        case LA16_IO_PORT_BLOCK_COUNT:
+            *val = block->sector_cnt;
+            break;
+        default:
+            break;
+    }
+    pthread_mutex_unlock(&block->lock);
+}
+
+static void la16_block_port_out(void *device,
+                                la16_core_t core,
+                                unsigned short port,
+                                unsigned short val)
+{
+    la16_block_t *block = device;
+
+    pthread_mutex_lock(&block->lock);
+    switch(port)
+    {
+        case LA16_IO_PORT_BLOCK_SECTOR:
+            block->sector = val;
+            break;
+        case LA16_IO_PORT_BLOCK_ADDR:
+            block->addr = val;
+            break;
+        case LA16_IO_PORT_BLOCK_CMD:
+            la16_block_command(block, core, val);
+            break;
+        default:
+            break;
+    }
+    pthread_mutex_unlock(&block->lock);
+}
+
+void la16_block_register(la16_block_t *block,
+                         la16_bus_t *bus)
+{
+    la16_bus_register(bus, LA16_IO_PORT_BLOCK_SECTOR, block, la16_block_port_in, la16_block_port_out);
+    la16_bus_register(bus, LA16_IO_PORT_BLOCK_ADDR, block, la16_block_port_in, la16_block_port_out);
+    la16_bus_register(bus, LA16_IO_PORT_BLOCK_CMD, block, la16_block_port_in, la16_block_port_out);
+    la16_bus_register(bus, LA16_IO_PORT_BLOCK_COUNT, block, la16_block_port_in, NULL);
+}
+
+/* copies len bytes starting at sector for the dma engine, they may span sectors */
+unsigned char la16_block_transfer(la16_block_t *block,
+                                  unsigned short sector,
+                                  unsigned char *memory,
+                                  unsigned short len,
+                                  unsigned char write)
+{
+    size_t off = (size_t)sector * LA16_BLOCK_SECTOR_SIZE;
+    if(off + len > block->map_size)
+    {
+        return 0b0;
+    }
+
+    /* the worker may be copying a guest command into the same sectors */
+    pthread_mutex_lock(&block->lock);
+    if(write)
+    {
+        memcpy(&block->map[off], memory, len);
+    }
+    else
+    {
+        memcpy(memory, &block->map[off], len);
+    }
+    pthread_mutex_unlock(&block->lock);
+    return 0b1;
+}
@@ -0,0 +1,81 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LA16_BLOCK_H
+#define LA16_BLOCK_H
+
+#include <pthread.h>
+#include <la16/core.h>
+#include <la16/bus.h>
+
+#define LA16_BLOCK_SECTOR_SIZE      256
+#define LA16_BLOCK_SECTOR_MAX       0xFFFF
+
+/* commands written to the command port */
+#define LA16_BLOCK_CMD_READ         0x1         /* sector into guest memory */
+#define LA16_BLOCK_CMD_WRITE        0x2         /* guest memory into sector */
+
+/* bits read from the command port */
+#define LA16_BLOCK_STATUS_BUSY      0b01
+#define LA16_BLOCK_STATUS_ERROR     0b10
+
+/*
+ * a host file mapped as numbered sectors, a command copies one
+ * sector between the mapping and the physical guest address set
+ * before, it completes on the device thread and raises
+ * LA16_INT_BLOCK on the core that issued it
+ */
+struct la16_block
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;                    /* wakes the device thread on a command and on stop */
+    pthread_t worker;
+    unsigned char *map;
+    size_t map_size;
+    unsigned short sector_cnt;
+
+    /* registers the guest sets up */
+    unsigned short sector;
+    unsigned short addr;
+
+    /* command in flight, latched from the registers */
+    unsigned short cmd;
+    unsigned short cmd_sector;
+    unsigned short cmd_addr;
+    la16_core_t cmd_core;
+    unsigned short status;
+    unsigned char stop;
+
+    la16_machine_t *machine;
+};
+
+typedef struct la16_block la16_block_t;
+
+la16_block_t *la16_block_alloc(la16_machine_t *machine, const char *path);
+void la16_block_dealloc(la16_block_t *block);
+
+void la16_block_register(la16_block_t *block, la16_bus_t *bus);
+unsigned char la16_block_transfer(la16_block_t *block, unsigned short sector, unsigned char *memory, unsigned short len, unsigned char write);
+
+#endif /* LA16_BLOCK_H */
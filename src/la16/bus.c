@@ -0,0 +1,57 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <la16/bus.h>
+
+la16_bus_t *la16_bus_alloc(void)
+{
+    return calloc(1, sizeof(la16_bus_t));
+}
+
+void la16_bus_dealloc(la16_bus_t *bus)
+{
+    free(bus);
+}
+
+unsigned char la16_bus_register(la16_bus_t *bus,
+                                unsigned short port,
+                                void *device,
+                                la16_bus_in_t in,
+                                la16_bus_out_t out)
+{
+    /* a port belongs to one device */
+    if(port >= LA16_BUS_PORT_CNT ||
+       bus->port[port].in != NULL ||
+       bus->port[port].out != NULL)
+    {
+        return 0b0;
+    }
+
+    bus->port[port].device = device;
+    bus->port[port].in = in;
+    bus->port[port].out = out;
+
+    return 0b1;
+}
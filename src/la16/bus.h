@@ -0,0 +1,80 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LA16_BUS_H
+#define LA16_BUS_H
+
+#include <la16/core.h>
+
+#define LA16_BUS_PORT_CNT   0x100
+
+/*
+ * a device reads into val only if it has something to give,
+ * the register of the in instruction stays as it is otherwise
+ */
+typedef void (*la16_bus_in_t)(void *device, la16_core_t core, unsigned short port, unsigned short *val);
+typedef void (*la16_bus_out_t)(void *device, la16_core_t core, unsigned short port, unsigned short val);
+
+typedef struct {
+    void *device;                           /* state handed to the callbacks */
+    la16_bus_in_t in;
+    la16_bus_out_t out;
+} la16_bus_port_t;
+
+/* ports nothing is registered on ignore writes and leave reads alone */
+struct la16_bus
+{
+    la16_bus_port_t port[LA16_BUS_PORT_CNT];
+};
+
+typedef struct la16_bus la16_bus_t;
+
+la16_bus_t *la16_bus_alloc(void);
+void la16_bus_dealloc(la16_bus_t *bus);
+
+unsigned char la16_bus_register(la16_bus_t *bus, unsigned short port, void *device, la16_bus_in_t in, la16_bus_out_t out);
+
+static inline void la16_bus_in(la16_bus_t *bus,
+                               la16_core_t core,
+                               unsigned short port,
+                               unsigned short *val)
+{
+    if(port < LA16_BUS_PORT_CNT && bus->port[port].in != NULL)
+    {
+        bus->port[port].in(bus->port[port].device, core, port, val);
+    }
+}
+
+static inline void la16_bus_out(la16_bus_t *bus,
+                                la16_core_t core,
+                                unsigned short port,
+                                unsigned short val)
+{
+    if(port < LA16_BUS_PORT_CNT && bus->port[port].out != NULL)
+    {
+        bus->port[port].out(bus->port[port].device, core, port, val);
+    }
+}
+
+#endif /* LA16_BUS_H */
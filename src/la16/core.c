@@ -27,9 +27,14 @@
 #include <la16/register.h>
 #include <la16/memory.h>
 #include <la16/machine.h>
+#include <la16/timer.h>
 #include <pthread.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
 #include <la16/instruction/core.h>
 #include <la16/instruction/data.h>
@@ -37,6 +42,7 @@
 #include <la16/instruction/arithmetic.h>
 #include <la16/instruction/execution.h>
 #include <la16/instruction/ic.h>
+#include <la16/instruction/cmc.h>
 
 #include <coder/bitwalker.h>
 
@@ -111,19 +117,44 @@ la16_opfunc_t opfunc_table[LA16_OPCODE_MAX + 1] = {
     la16_op_vpaddr,
 
     /* core concurrency */
+    la16_op_crresume,
     NULL,
     NULL,
     NULL,
+    la16_op_crtimeset,
     NULL,
     NULL,
-    NULL,
-    NULL,
+
+    /* masked control flow operations */
+    la16_op_blm,
+    la16_op_retm,
+
+    /* compare and branch operations */
+    la16_op_beq,
+    la16_op_bne,
+    la16_op_blt,
+    la16_op_bgt,
+    la16_op_ble,
+    la16_op_bge,
+
+    /* block memory operations */
+    la16_op_mcpy,
+    la16_op_mset,
+    la16_op_mcmp,
+
+    /* idle operations */
+    la16_op_wfi,
+
+    /* interrupt bank operations */
+    la16_op_bnkget,
+    la16_op_bnkset,
 };
 
 la16_core_t la16_core_alloc()
 {
     // Allocate new core
     la16_core_t core = calloc(1, sizeof(struct la16_core));
+    la16_irq_init(&core->irq);
 
     // Allocate all 8 registers
     for(unsigned char i = 0b0000; i < (LA16_REGISTER_EL1_MAX + 1); i++)
@@ -142,6 +173,9 @@ la16_core_t la16_core_alloc()
     // A core always starts in EL1
     *(core->el) = LA16_CORE_MODE_EL1;
 
+    // The timer starts stopped
+    core->timer = la16_timer_alloc(core);
+
     return core;
 }
 
@@ -153,6 +187,7 @@ void la16_core_dealloc(la16_core_t core)
         la16_register_dealloc(core->rl[i]);
     }
 
+    la16_timer_dealloc(core->timer);
     free(core);
 }
 
@@ -189,6 +224,7 @@ static void la16_core_decode_instruction_at_pc(la16_core_t core)
 
     /* extracting mode */
     unsigned char mode = (uint8_t)bitwalker_read(&bw, 3);
+    core->op.mode = mode;
 
     /* setting parameter to intermediate */
     core->op.param[0] = &(core->op.imm[0]);
@@ -209,6 +245,11 @@ static void la16_core_decode_instruction_at_pc(la16_core_t core)
             core->op.reg[1] = (uint8_t)bitwalker_read(&bw, 5);
             core->op.param[0] = core->rl[core->op.reg[0]];
             core->op.param[1] = core->rl[core->op.reg[1]];
+
+            /* sign extending the displacement of memory operands */
+            unsigned short memory = (uint16_t)bitwalker_read(&bw, LA16_MEMORY_OPERAND_BITS);
+            core->op.disp = (signed short)((memory & LA16_MEMORY_DISP_MASK) << 6) >> 6;
+            core->op.postinc = (memory & LA16_MEMORY_POSTINC) != 0;
             goto out_res_a_check;
         }
         case LA16_PARAMETER_CODING_COMBINATION_IMM16:
@@ -234,6 +275,20 @@ static void la16_core_decode_instruction_at_pc(la16_core_t core)
         {
             core->op.imm[0] = (uint8_t)bitwalker_read(&bw, 8);
             core->op.imm[1] = (uint8_t)bitwalker_read(&bw, 8);
+
+            /* register of an immediate compare and branch */
+            core->op.reg[0] = (uint8_t)bitwalker_read(&bw, 5);
+            if(core->op.reg[0] > LA16_REGISTER_EL0_MAX && *(core->el) == LA16_CORE_MODE_EL0)
+            {
+                core->op.op = LA16_OPCODE_HLT;
+                core->term = LA16_TERM_FLAG_PERMISSION;
+            }
+            break;
+        }
+        case LA16_PARAMETER_CODING_COMBINATION_IMM16_IMM5:
+        {
+            core->op.imm[0] = (uint16_t)bitwalker_read(&bw, 16);
+            core->op.imm[1] = (uint8_t)bitwalker_read(&bw, 5);
             break;
         }
         default:
@@ -256,17 +311,71 @@ out_res_a_check:
     return;
 }
 
-static void *la16_core_execute_thread(void *arg)
+/*
+ * takes the next interrupt the guest has a handler for, parked ones
+ * that got a handler since come first, queued ones without a handler
+ * get parked so they neither hold back the ones behind them nor get
+ * lost for a handler set later
+ */
+static bool la16_core_next(la16_core_t core,
+                           unsigned short *vector)
 {
-    // Now execute fr
-    la16_core_t core = arg;
+    la16_irq_queue_t *irq = &core->irq;
 
-    // Set runs flag
-    core->runs = 0b00000001;
-    core->term = 0b00000000;
+    for(unsigned short w = 0; irq->parked_cnt != 0 && w < LA16_IRQ_PARKED_MAX / 32; w++)
+    {
+        for(unsigned short b = 0; b < 32 && irq->parked[w] >> b; b++)
+        {
+            unsigned short parked = w * 32 + b;
+            if((irq->parked[w] >> b) & 1 && core->machine->int_handler[parked] != 0x0)
+            {
+                la16_irq_unpark(irq, parked);
+                *vector = parked;
+                return true;
+            }
+        }
+    }
 
+    while(la16_irq_peek(irq, vector))
+    {
+        la16_irq_take(irq);
+        if(core->machine->int_handler[*vector] != 0x0)
+        {
+            return true;
+        }
+        la16_irq_park(irq, *vector);
+    }
+    return false;
+}
+
+/*
+ * enters the handler of a pending device interrupt as if int was
+ * executed right before the instruction at pc
+ */
+static void la16_core_interrupt(la16_core_t core)
+{
+    unsigned short vector;
+    if(!la16_core_next(core, &vector))
+    {
+        return;
+    }
+
+    core->op.param[0] = &vector;
+    *(core->pc) -= 4;
+    la16_op_int(core);
+    *(core->pc) += 4;
+}
+
+static void la16_core_execute_loop(la16_core_t core)
+{
     while(1)
     {
+        /* guest output goes out before the reason it stopped */
+        if(core->term != LA16_TERM_FLAG_NONE)
+        {
+            la16_serial_flush(core->machine->serial);
+        }
+
         switch(core->term)
         {
             case LA16_TERM_FLAG_NONE:
@@ -274,56 +383,180 @@ static void *la16_core_execute_thread(void *arg)
             case LA16_TERM_FLAG_HALT:
                 printf("[exec] halted at 0x%x\n", *(core->pc));
                 core->runs = 0b00000000;
-                return NULL;
+                return;
             case LA16_TERM_FLAG_BAD_ACCESS:
                 printf("[exec] bad access at 0x%x\n", *(core->pc));
                 core->runs = 0b00000000;
-                return NULL;
+                return;
             case LA16_TERM_FLAG_PERMISSION:
                 printf("[exec] permission denied at 0x%x\n", *(core->pc));
                 core->runs = 0b00000000;
-                return NULL;
+                return;
             default:
                 printf("[exec] unknown exception at 0x%x\n", *(core->pc));
                 break;
         }
 
-        la16_core_decode_instruction_at_pc(core);
+        if(la16_irq_pending(&core->irq))
+        {
+            la16_core_interrupt(core);
+        }
 
-        if(core->op.op <= LA16_OPCODE_MAX && opfunc_table[core->op.op] != NULL)
+        // Running a whole slice looking at nothing but termination, the timer counts slices
+        unsigned long slice = LA16_CORE_SLICE;
+        if(core->timer->period != 0 && core->timer->left < slice)
         {
-            opfunc_table[core->op.op](core);
+            slice = core->timer->left;
         }
-        else
+
+        unsigned long ran = 0;
+        while(ran < slice && core->term == LA16_TERM_FLAG_NONE)
         {
-            printf("[exec] illegal opcode: 0x%x\n", core->op.op);
-            opfunc_table[LA16_OPCODE_HLT](core);
+            la16_core_decode_instruction_at_pc(core);
+
+            if(core->op.op <= LA16_OPCODE_MAX && opfunc_table[core->op.op] != NULL)
+            {
+                opfunc_table[core->op.op](core);
+            }
+            else
+            {
+                printf("[exec] illegal opcode: 0x%x\n", core->op.op);
+                opfunc_table[LA16_OPCODE_HLT](core);
+            }
+
+            *(core->pc) += 4;
+            ran++;
         }
 
-        *(core->pc) += 4;
+        la16_timer_retire(core->timer, ran);
     }
 
     core->runs = 0b00000000;
-    return NULL;
 }
 
 
+static void *la16_core_execute_thread(void *arg)
+{
+    // Now execute fr
+    la16_core_t core = arg;
+    la16_core_execute_loop(core);
+
+    // A core that stopped on its own can be resumed again
+    atomic_store(&core->started, 0);
+    return NULL;
+}
+
 void la16_core_execute(la16_core_t core)
 {
-    // Check if core already runs
-    if(core->runs)
+    // Creating new pthread and joining it
+    if(!la16_core_resume(core, *(core->pc)))
     {
         return;
     }
+    pthread_join(core->thread, NULL);
+    core->joinable = 0;
+}
 
-    // Creating new pthread and joining it
-    pthread_t pthread;
-    pthread_create(&pthread, NULL, la16_core_execute_thread, (void*)core);
-    pthread_join(pthread, NULL);
+bool la16_core_resume(la16_core_t core, unsigned short entry)
+{
+    // Check if core already runs, winning this owns the thread handle
+    if(atomic_exchange(&core->started, 1))
+    {
+        return false;
+    }
+
+    // Reaping the thread of the run that ended
+    if(core->joinable)
+    {
+        pthread_join(core->thread, NULL);
+        core->joinable = 0;
+    }
+
+    // Clearing term before the thread exists so stopping it right away sticks
+    *(core->pc) = entry;
+    core->runs = 0b00000001;
+    core->term = 0b00000000;
+    core->bank.depth = 0;
+
+    pthread_create(&core->thread, NULL, la16_core_execute_thread, (void*)core);
+    core->joinable = 1;
+    return true;
+}
+
+void la16_core_stop(la16_core_t core)
+{
+    // A core still running is told to stop, one that ended only needs reaping
+    if(atomic_load(&core->started))
+    {
+        la16_core_terminate(core);
+    }
+
+    if(core->joinable)
+    {
+        pthread_join(core->thread, NULL);
+        core->joinable = 0;
+    }
+}
+
+void la16_core_wake(la16_core_t core)
+{
+    // Bumping the word makes a wfi about to sleep return right away
+    atomic_fetch_add(&core->wake, 1);
+    if(atomic_load(&core->idle))
+    {
+        syscall(SYS_futex, &core->wake, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    }
 }
 
 void la16_core_terminate(la16_core_t core)
 {
     // Terminates the core
     core->term = 0b00000001;
+    la16_core_wake(core);
+}
+
+bool la16_core_raise(la16_core_t core, unsigned short vector)
+{
+    // A full queue drops the interrupt, devices keep their state in ports anyways
+    bool posted = la16_irq_post(&core->irq, vector);
+    la16_core_wake(core);
+    return posted;
+}
+
+/*
+ * sleeps the core thread until an interrupt with a handler is
+ * pending and enters it, called by wfi so the handler returns to the
+ * instruction behind it, a sleeping core retires nothing so a timer
+ * counting retired instructions cannot wake it
+ */
+void la16_core_wait(la16_core_t core)
+{
+    unsigned short vector;
+    bool taken = false;
+
+    atomic_store(&core->idle, 1);
+    while(1)
+    {
+        unsigned int wake = atomic_load(&core->wake);
+        if(core->term != LA16_TERM_FLAG_NONE)
+        {
+            break;
+        }
+        if(la16_core_next(core, &vector))
+        {
+            taken = true;
+            break;
+        }
+        syscall(SYS_futex, &core->wake, FUTEX_WAIT_PRIVATE, wake, NULL, NULL, 0);
+    }
+    atomic_store(&core->idle, 0);
+
+    if(!taken)
+    {
+        return;
+    }
+
+    /* pc is still on the wfi here, so int returns behind it */
+    core->op.param[0] = &vector;
+    la16_op_int(core);
 }
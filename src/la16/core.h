@@ -25,7 +25,10 @@
 #ifndef LA16_CORE_H
 #define LA16_CORE_H
 
+#include <stdbool.h>
+#include <pthread.h>
 #include <la16/register.h>
+#include <la16/irq.h>
 
 #pragma mark - opcode
 
@@ -107,7 +110,31 @@
 #define LA16_OPCODE_CRCTXHNDLSET    0b00111010
 #define LA16_OPCODE_CREXCHNDLSET    0b00111011
 
-#define LA16_OPCODE_MAX             LA16_OPCODE_CREXCHNDLSET
+/* masked control flow operations */
+#define LA16_OPCODE_BLM             0b00111100
+#define LA16_OPCODE_RETM            0b00111101
+
+/* compare and branch operations */
+#define LA16_OPCODE_BEQ             0b00111110
+#define LA16_OPCODE_BNE             0b00111111
+#define LA16_OPCODE_BLT             0b01000000
+#define LA16_OPCODE_BGT             0b01000001
+#define LA16_OPCODE_BLE             0b01000010
+#define LA16_OPCODE_BGE             0b01000011
+
+/* block memory operations */
+#define LA16_OPCODE_MCPY            0b01000100
+#define LA16_OPCODE_MSET            0b01000101
+#define LA16_OPCODE_MCMP            0b01000110
+
+/* idle operations */
+#define LA16_OPCODE_WFI             0b01000111
+
+/* interrupt bank operations */
+#define LA16_OPCODE_BNKGET          0b01001000
+#define LA16_OPCODE_BNKSET          0b01001001
+
+#define LA16_OPCODE_MAX             LA16_OPCODE_BNKSET
 
 #pragma mark - parameter combination
 
@@ -118,6 +145,41 @@
 #define LA16_PARAMETER_CODING_COMBINATION_IMM16_REG 0b100
 #define LA16_PARAMETER_CODING_COMBINATION_REG_IMM16 0b101
 #define LA16_PARAMETER_CODING_COMBINATION_IMM8_IMM8 0b110
+#define LA16_PARAMETER_CODING_COMBINATION_IMM16_IMM5 0b111
+
+#pragma mark - memory operand
+
+/*
+ * register register instructions carry 11 more bits, memory
+ * instructions read them as a signed displacement of their
+ * address register and a post increment flag
+ */
+#define LA16_MEMORY_OPERAND_BITS    11
+#define LA16_MEMORY_DISP_MIN        -512
+#define LA16_MEMORY_DISP_MAX        511
+#define LA16_MEMORY_DISP_MASK       0b01111111111
+#define LA16_MEMORY_POSTINC         0b10000000000
+
+#pragma mark - branch offset
+
+/*
+ * compare and branch instructions jump relative to themselves in
+ * instructions, a register register compare keeps the offset in the
+ * displacement bits, a register immediate compare in its first 8bit
+ * immediate with the register in the 5 bits behind the second
+ */
+#define LA16_BRANCH_OFFSET_MIN      LA16_MEMORY_DISP_MIN
+#define LA16_BRANCH_OFFSET_MAX      LA16_MEMORY_DISP_MAX
+#define LA16_BRANCH_OFFSET8_MIN     -128
+#define LA16_BRANCH_OFFSET8_MAX     127
+
+#pragma mark - block length
+
+/*
+ * block memory instructions take their byte count from a
+ * third register kept in the low displacement bits
+ */
+#define LA16_BLOCK_REG_MASK         0b00000011111
 
 #pragma mark - register
 
@@ -159,6 +221,39 @@
 #define LA16_REGISTER_EL0_MAX   LA16_REGISTER_RR
 #define LA16_REGISTER_EL1_MAX   LA16_REGISTER_ELB
 
+#pragma mark - shadow bank
+
+/*
+ * the outermost interrupt keeps the registers it interrupted in
+ * the core instead of spilling them to the stack, only interrupts
+ * nested into it take the stack path of int and intret
+ *
+ * bnkget reg, banked and bnkset banked, reg let a handler read and
+ * change what intret returns to, the banked register is named like
+ * the live one (pc, sp, r0, el, ...), rr is not banked and reads and
+ * writes the live rr, an interrupt taken from el0 starts the bank
+ * over so a handler left without intret cannot wedge it
+ */
+#define LA16_BANK_REG_CNT       (LA16_REGISTER_R24 + 1)
+
+typedef struct {
+    unsigned short reg[LA16_BANK_REG_CNT];      /* pc, sp, fp, cf and r0 to r24 */
+    unsigned short el;
+    unsigned short elb;
+    unsigned int depth;                         /* interrupts entered and not returned from */
+} la16_bank_t;
+
+#pragma mark - call save mask
+
+/* register groups blm saves and retm restores, pc and fp are always saved */
+#define LA16_CALL_SAVE_NONE     0b00000
+#define LA16_CALL_SAVE_CF       0b00001
+#define LA16_CALL_SAVE_R0_R6    0b00010
+#define LA16_CALL_SAVE_R7_R12   0b00100
+#define LA16_CALL_SAVE_R13_R18  0b01000
+#define LA16_CALL_SAVE_R19_R24  0b10000
+#define LA16_CALL_SAVE_ALL      0b11111
+
 #pragma mark - compare flags
 
 #define LA16_CMP_Z  0x1
@@ -177,6 +272,12 @@
 #define LA16_TERM_FLAG_BAD_ACCESS   0b10
 #define LA16_TERM_FLAG_PERMISSION   0b11
 
+#pragma mark - device interrupts
+
+#define LA16_INT_SERIAL             0x10        /* serial input arrived */
+#define LA16_INT_BLOCK              0x11        /* block command completed */
+#define LA16_INT_DMA                0x12        /* dma batch completed */
+
 #pragma mark - flags
 
 #define LA16_PAGEU_FLAG_NONE        0b0000
@@ -186,12 +287,20 @@
 #define LA16_PAGEU_FLAG_EXEC        0b1000
 
 typedef struct la16_machine la16_machine_t;
+typedef struct la16_timer la16_timer_t;
+
+#pragma mark - execution
+
+#define LA16_CORE_SLICE             256         /* instructions run between looking at interrupts and the timer */
 
 typedef struct {
     unsigned char op;
     unsigned char reg[2];
     unsigned short imm[2];
     unsigned short *param[2];
+    unsigned char mode;         /* parameter coding combination of the instruction */
+    signed short disp;          /* displacement of a memory operand */
+    unsigned char postinc;      /* incrementing the address register of a memory operand */
 } la16_operation_t;
 
 struct la16_core {
@@ -210,12 +319,30 @@ struct la16_core {
     /* Opertion registers */
     la16_operation_t op;
 
+    /* Shadow registers of the outermost interrupt */
+    la16_bank_t bank;
+
     /* Exec flags */
     unsigned char runs;
-    unsigned char term;
+    _Atomic unsigned char term;
+    pthread_t thread;
+    _Atomic unsigned char started;          /* the thread of the core is running */
+    unsigned char joinable;                 /* thread was created and not joined yet */
+
+    /* Device interrupts posted from any thread, taken in order before the next slice */
+    la16_irq_queue_t irq;
+    la16_timer_t *timer;
+
+    /* Futex word bumped by anything that should end a wfi, futex only woken while idle */
+    _Atomic unsigned int wake;
+    _Atomic unsigned char idle;
+
+    /* Bits other cores posted for this one through the ipi device */
+    _Atomic unsigned short mailbox;
 
     /* Machine related things */
     la16_machine_t *machine;
+    unsigned char id;
     unsigned short page[257];
     unsigned char pageu[257];
 };
@@ -228,6 +355,11 @@ extern la16_opfunc_t opfunc_table[];
 la16_core_t la16_core_alloc();
 void la16_core_dealloc(la16_core_t core);
 void la16_core_execute(la16_core_t core);
+bool la16_core_resume(la16_core_t core, unsigned short entry);
+void la16_core_stop(la16_core_t core);
 void la16_core_terminate(la16_core_t core);
+bool la16_core_raise(la16_core_t core, unsigned short vector);
+void la16_core_wait(la16_core_t core);
+void la16_core_wake(la16_core_t core);
 
 #endif /* LA16_CORE_H */
@@ -0,0 +1,262 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <la16/dma.h>
+#include <la16/machine.h>
+#include <la16/instruction/data.h>
+
+static unsigned short la16_dma_word(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static void la16_dma_set_word(unsigned char *p,
+                              unsigned short val)
+{
+    p[0] = val & 0xFF;
+    p[1] = val >> 8;
+}
+
+/* moves one descriptor, returns the bytes moved or -1 */
+static long la16_dma_transfer(la16_dma_t *dma,
+                              unsigned char *desc)
+{
+    la16_machine_t *machine = dma->machine;
+    unsigned short addr = la16_dma_word(&desc[0]);
+    unsigned short len = la16_dma_word(&desc[2]);
+    unsigned short flags = la16_dma_word(&desc[4]);
+    unsigned short arg = la16_dma_word(&desc[6]);
+
+    if((unsigned long)addr + len > machine->memory->memory_size)
+    {
+        return -1;
+    }
+
+    unsigned char *memory = &machine->memory->memory[addr];
+    unsigned char write = (flags & LA16_DMA_FLAG_WRITE) != 0;
+
+    switch(flags >> 8)
+    {
+        case LA16_DMA_DEVICE_SERIAL:
+            if(write)
+            {
+                la16_serial_write(machine->serial, memory, len);
+                return len;
+            }
+            return la16_serial_read(machine->serial, memory, len);
+        case LA16_DMA_DEVICE_BLOCK:
+            if(machine->block == NULL ||
+               !la16_block_transfer(machine->block, arg, memory, len, write))
+            {
+                return -1;
+            }
+            return len;
+        default:
+            return -1;
+    }
+}
+
+static void *la16_dma_worker(void *arg)
+{
+    la16_dma_t *dma = arg;
+
+    pthread_mutex_lock(&dma->lock);
+    while(1)
+    {
+        while(dma->head == dma->tail && !dma->stop)
+        {
+            pthread_cond_wait(&dma->cond, &dma->lock);
+        }
+        if(dma->stop)
+        {
+            break;
+        }
+
+        // Taking the whole batch posted so far
+        unsigned short head = dma->head;
+        unsigned short tail = dma->tail;
+        unsigned short ring = dma->ring;
+        unsigned short size = dma->size;
+        la16_core_t core = dma->core;
+        pthread_mutex_unlock(&dma->lock);
+
+        for(; head != tail; head = (head + 1) % size)
+        {
+            unsigned char *desc = &dma->machine->memory->memory[ring + head * LA16_DMA_DESC_SIZE];
+            long moved = la16_dma_transfer(dma, desc);
+
+            unsigned short flags = la16_dma_word(&desc[4]) | LA16_DMA_FLAG_DONE;
+            if(moved < 0)
+            {
+                flags |= LA16_DMA_FLAG_ERROR;
+            }
+            else
+            {
+                la16_dma_set_word(&desc[2], (unsigned short)moved);
+            }
+            la16_dma_set_word(&desc[4], flags);
+        }
+
+        pthread_mutex_lock(&dma->lock);
+        dma->head = head;
+        if(dma->head == dma->tail)
+        {
+            dma->status &= ~LA16_DMA_STATUS_BUSY;
+        }
+        pthread_mutex_unlock(&dma->lock);
+
+        la16_core_raise(core, LA16_INT_DMA);
+
+        pthread_mutex_lock(&dma->lock);
+    }
+    pthread_mutex_unlock(&dma->lock);
+
+    return NULL;
+}
+
+la16_dma_t *la16_dma_alloc(la16_machine_t *machine)
+{
+    la16_dma_t *dma = calloc(1, sizeof(la16_dma_t));
+    pthread_mutex_init(&dma->lock, NULL);
+    pthread_cond_init(&dma->cond, NULL);
+    dma->machine = machine;
+
+    pthread_create(&dma->worker, NULL, la16_dma_worker, dma);
+
+    return dma;
+}
+
+void la16_dma_dealloc(la16_dma_t *dma)
+{
+    pthread_mutex_lock(&dma->lock);
+    dma->stop = 1;
+    pthread_cond_signal(&dma->cond);
+    pthread_mutex_unlock(&dma->lock);
+    pthread_join(dma->worker, NULL);
+
+    pthread_cond_destroy(&dma->cond);
+    pthread_mutex_destroy(&dma->lock);
+    free(dma);
+}
+
+static void la16_dma_doorbell(la16_dma_t *dma,
+                              la16_core_t core,
+                              unsigned short tail)
+{
+    /* the ring has to fit into memory and may not move while the engine works on it */
+    if(dma->size == 0 ||
+       dma->size > LA16_DMA_RING_MAX ||
+       tail >= dma->size ||
+       (unsigned long)dma->ring + dma->size * LA16_DMA_DESC_SIZE > dma->machine->memory->memory_size)
+    {
+        dma->status |= LA16_DMA_STATUS_ERROR;
+        return;
+    }
+
+    dma->tail = tail;
+    dma->core = core;
+    if(dma->head != dma->tail)
+    {
+        dma->status |= LA16_DMA_STATUS_BUSY;
+        pthread_cond_signal(&dma->cond);
+    }
+}
+
+static void la16_dma_port_in(void *device,
+                             la16_core_t core,
+                             unsigned short port,
+                             unsigned short *val)
+{
+    la16_dma_t *dma = device;
+
+    pthread_mutex_lock(&dma->lock);
+    switch(port)
+    {
+        case LA16_IO_PORT_DMA_RING:
+            *val = dma->ring;
+            break;
+        case LA16_IO_PORT_DMA_SIZE:
+            *val = dma->size;
+            break;
+        case LA16_IO_PORT_DMA_DOORBELL:
+            *val = dma->head;
+            break;
+        case LA16_IO_PORT_DMA_STATUS:
+            *val = dma->status;
+            break;
+        default:
+            break;
+    }
+    pthread_mutex_unlock(&dma->lock);
+}
+
+static void la16_dma_port_out(void *device,
+                              la16_core_t core,
+                              unsigned short port,
+                              unsigned short val)
+{
+    la16_dma_t *dma = device;
+
+    pthread_mutex_lock(&dma->lock);
+    switch(port)
+    {
+        case LA16_IO_PORT_DMA_RING:
+        case LA16_IO_PORT_DMA_SIZE:
+            /* setting up a new ring starts it over */
+            if(dma->status & LA16_DMA_STATUS_BUSY)
+            {
+                dma->status |= LA16_DMA_STATUS_ERROR;
+                break;
+            }
+            if(port == LA16_IO_PORT_DMA_RING)
+            {
+                dma->ring = val;
+            }
+            else
+            {
+                dma->size = val;
+            }
+            dma->head = 0;
+            dma->tail = 0;
+            dma->status = 0;
+            break;
+        case LA16_IO_PORT_DMA_DOORBELL:
+            la16_dma_doorbell(dma, core, val);
+            break;
+        default:
+            break;
+    }
+    pthread_mutex_unlock(&dma->lock);
+}
+
+void la16_dma_register(la16_dma_t *dma,
+                       la16_bus_t *bus)
+{
+    la16_bus_register(bus, LA16_IO_PORT_DMA_RING, dma, la16_dma_port_in, la16_dma_port_out);
+    la16_bus_register(bus, LA16_IO_PORT_DMA_SIZE, dma, la16_dma_port_in, la16_dma_port_out);
+    la16_bus_register(bus, LA16_IO_PORT_DMA_DOORBELL, dma, la16_dma_port_in, la16_dma_port_out);
+    la16_bus_register(bus, LA16_IO_PORT_DMA_STATUS, dma, la16_dma_port_in, NULL);
+}
@@ -0,0 +1,86 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LA16_DMA_H
+#define LA16_DMA_H
+
+#include <pthread.h>
+#include <la16/core.h>
+#include <la16/bus.h>
+
+#define LA16_DMA_DESC_SIZE          8
+#define LA16_DMA_RING_MAX           0x100
+
+/*
+ * descriptor in guest memory, all fields are little endian words
+ *
+ *  +0  physical guest address
+ *  +2  length in bytes, the engine writes back what it moved
+ *  +4  flags, device in the high byte
+ *  +6  device argument, the first sector for the block device
+ */
+#define LA16_DMA_FLAG_WRITE         0b001       /* memory to device, otherwise device to memory */
+#define LA16_DMA_FLAG_DONE          0b010       /* set by the engine */
+#define LA16_DMA_FLAG_ERROR         0b100       /* set by the engine */
+
+#define LA16_DMA_DEVICE_SERIAL      0x00
+#define LA16_DMA_DEVICE_BLOCK       0x01
+
+/* bits read from the status port */
+#define LA16_DMA_STATUS_BUSY        0b01
+#define LA16_DMA_STATUS_ERROR       0b10        /* the ring itself was bad */
+
+/*
+ * the guest fills descriptors into a ring and writes the index
+ * after its last one to the doorbell, the engine works through
+ * them on its own thread, moving the index read from the doorbell
+ * port along, and raises LA16_INT_DMA once per batch
+ */
+struct la16_dma
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;                    /* wakes the engine on a doorbell and on stop */
+    pthread_t worker;
+
+    /* registers the guest sets up */
+    unsigned short ring;
+    unsigned short size;
+
+    unsigned short head;                    /* next descriptor the engine takes */
+    unsigned short tail;                    /* descriptor after the last one posted */
+    unsigned short status;
+    la16_core_t core;                       /* core that rang last */
+    unsigned char stop;
+
+    la16_machine_t *machine;
+};
+
+typedef struct la16_dma la16_dma_t;
+
+la16_dma_t *la16_dma_alloc(la16_machine_t *machine);
+void la16_dma_dealloc(la16_dma_t *dma);
+
+void la16_dma_register(la16_dma_t *dma, la16_bus_t *bus);
+
+#endif /* LA16_DMA_H */
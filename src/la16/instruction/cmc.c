@@ -21,3 +21,37 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
  * SOFTWARE.
  */
+
+#include <la16/instruction/cmc.h>
+#include <la16/timer.h>
+#include <la16/machine.h>
+
+void la16_op_crresume(la16_core_t core)
+{
+    /* checking if running in user level which cannot use this opcode */
+    if(*(core->el) != LA16_CORE_MODE_EL1)
+    {
+        core->term = LA16_TERM_FLAG_PERMISSION;
+        return;
+    }
+
+    /* starting another core at an entry point, a running one is left alone */
+    unsigned short id = *(core->op.param[0]);
+    if(id < LA16_MACHINE_CORE_CNT)
+    {
+        la16_core_resume(core->machine->core[id], *(core->op.param[1]));
+    }
+}
+
+void la16_op_crtimeset(la16_core_t core)
+{
+    /* checking if running in user level which cannot use this opcode */
+    if(*(core->el) != LA16_CORE_MODE_EL1)
+    {
+        core->term = LA16_TERM_FLAG_PERMISSION;
+        return;
+    }
+
+    /* programming this cores timer, a period of 0 stops it */
+    la16_timer_set(core->timer, *(core->op.param[0]), *(core->op.param[1]));
+}
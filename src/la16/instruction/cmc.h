@@ -21,3 +21,13 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
  * SOFTWARE.
  */
+
+#ifndef LA16_INSTRUCTION_CMC_H
+#define LA16_INSTRUCTION_CMC_H
+
+#include <la16/core.h>
+
+void la16_op_crresume(la16_core_t core);
+void la16_op_crtimeset(la16_core_t core);
+
+#endif /* LA16_INSTRUCTION_CMC_H */
@@ -23,10 +23,10 @@
  */
 
 #include <stdio.h>
-#include <termios.h>
-#include <unistd.h>
+#include <string.h>
 #include <la16/instruction/data.h>
 #include <la16/instruction/mpp.h>
+#include <la16/machine.h>
 
 void la16_op_push_ext(la16_core_t core, unsigned short val)
 {
@@ -66,18 +66,36 @@ void la16_op_swpz(la16_core_t core)
     *(core->op.param[1]) = 0;
 }
 
+/*
+ * address of a memory operand, the address register is
+ * incremented by the access width once its used
+ */
+static unsigned short la16_op_address(la16_core_t core,
+                                      unsigned short *base,
+                                      unsigned char width)
+{
+    unsigned short addr = *base + core->op.disp;
+    if(core->op.postinc)
+    {
+        *base += width;
+    }
+    return addr;
+}
+
 void la16_op_ldb(la16_core_t core)
 {
-    if(!la16_mpp_read8(core, *(core->op.param[1]), (unsigned char*)(core->op.param[0])))
+    unsigned char val = 0;
+    if(!la16_mpp_read8(core, la16_op_address(core, core->op.param[1], 1), &val))
     {
         core->term = LA16_TERM_FLAG_BAD_ACCESS;
     }
-    *(core->op.param[0]) = *(core->op.param[0]) & 0xFF;
+    *(core->op.param[0]) = val;
 }
 
 void la16_op_stb(la16_core_t core)
 {
-    if(!la16_mpp_write8(core, *(core->op.param[0]), (unsigned char)*(core->op.param[1])))
+    unsigned char val = (unsigned char)*(core->op.param[1]);
+    if(!la16_mpp_write8(core, la16_op_address(core, core->op.param[0], 1), val))
     {
         core->term = LA16_TERM_FLAG_BAD_ACCESS;
     }
@@ -85,15 +103,18 @@ void la16_op_stb(la16_core_t core)
 
 void la16_op_ldw(la16_core_t core)
 {
-    if(!la16_mpp_read(core, *(core->op.param[1]), core->op.param[0]))
+    unsigned short val = 0;
+    if(!la16_mpp_read(core, la16_op_address(core, core->op.param[1], 2), &val))
     {
         core->term = LA16_TERM_FLAG_BAD_ACCESS;
     }
+    *(core->op.param[0]) = val;
 }
 
 void la16_op_stw(la16_core_t core)
 {
-    if(!la16_mpp_write(core, *(core->op.param[0]), *(core->op.param[1])))
+    unsigned short val = *(core->op.param[1]);
+    if(!la16_mpp_write(core, la16_op_address(core, core->op.param[0], 2), val))
     {
         core->term = LA16_TERM_FLAG_BAD_ACCESS;
     }
@@ -107,22 +128,7 @@ void la16_op_in(la16_core_t core)
         return;
     }
 
-    switch(*(core->op.param[1]))
-    {
-        case LA16_IO_PORT_SERIAL:
-        {
-            struct termios oldt, newt;
-            tcgetattr(STDIN_FILENO, &oldt);
-            newt = oldt;
-            newt.c_lflag &= ~(ICANON | ECHO);
-            tcsetattr(STDIN_FILENO, TCSANOW, &newt);
-            read(STDIN_FILENO, core->op.param[0], 1);
-            tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
-            break;
-        }
-        default:
-            break;
-    }
+    la16_bus_in(core->machine->bus, core, *(core->op.param[1]), core->op.param[0]);
 }
 
 void la16_op_out(la16_core_t core)
@@ -133,16 +139,7 @@ void la16_op_out(la16_core_t core)
         return;
     }
 
-    switch(*(core->op.param[0]))
-    {
-        case LA16_IO_PORT_SERIAL:
-        {
-            write(STDOUT_FILENO, core->op.param[1], 1);
-            break;
-        }
-        default:
-            break;
-    }
+    la16_bus_out(core->machine->bus, core, *(core->op.param[0]), *(core->op.param[1]));
 }
 
 void la16_op_push(la16_core_t core)
@@ -164,3 +161,76 @@ void la16_op_pop(la16_core_t core)
         core->term = LA16_TERM_FLAG_BAD_ACCESS;
     }
 }
+
+/* byte count of a block instruction, the register sits where memory operands keep their displacement */
+static unsigned short *la16_op_block_length(la16_core_t core)
+{
+    unsigned char reg = core->op.disp & LA16_BLOCK_REG_MASK;
+    if(reg > LA16_REGISTER_EL0_MAX && *(core->el) == LA16_CORE_MODE_EL0)
+    {
+        core->term = LA16_TERM_FLAG_PERMISSION;
+        return NULL;
+    }
+    return core->rl[reg];
+}
+
+void la16_op_mcpy(la16_core_t core)
+{
+    unsigned short *len = la16_op_block_length(core);
+    if(len == NULL)
+    {
+        return;
+    }
+
+    unsigned short dst = *(core->op.param[0]);
+    unsigned short src = *(core->op.param[1]);
+    if(!la16_mpp_range(core, src, *len, LA16_PAGEU_FLAG_READ) ||
+       !la16_mpp_range(core, dst, *len, LA16_PAGEU_FLAG_WRITE))
+    {
+        core->term = LA16_TERM_FLAG_BAD_ACCESS;
+        return;
+    }
+
+    /* ranges may overlap */
+    memmove(&core->machine->memory->memory[dst], &core->machine->memory->memory[src], *len);
+}
+
+void la16_op_mset(la16_core_t core)
+{
+    unsigned short *len = la16_op_block_length(core);
+    if(len == NULL)
+    {
+        return;
+    }
+
+    unsigned short dst = *(core->op.param[0]);
+    if(!la16_mpp_range(core, dst, *len, LA16_PAGEU_FLAG_WRITE))
+    {
+        core->term = LA16_TERM_FLAG_BAD_ACCESS;
+        return;
+    }
+
+    memset(&core->machine->memory->memory[dst], (unsigned char)*(core->op.param[1]), *len);
+}
+
+void la16_op_mcmp(la16_core_t core)
+{
+    unsigned short *len = la16_op_block_length(core);
+    if(len == NULL)
+    {
+        return;
+    }
+
+    unsigned short a = *(core->op.param[0]);
+    unsigned short b = *(core->op.param[1]);
+    if(!la16_mpp_range(core, a, *len, LA16_PAGEU_FLAG_READ) ||
+       !la16_mpp_range(core, b, *len, LA16_PAGEU_FLAG_READ))
+    {
+        core->term = LA16_TERM_FLAG_BAD_ACCESS;
+        return;
+    }
+
+    /* sets cf like cmp would on the first differing byte */
+    int res = memcmp(&core->machine->memory->memory[a], &core->machine->memory->memory[b], *len);
+    *(core->cf) = (res == 0) * LA16_CMP_Z | (res <  0) * LA16_CMP_L | (res >  0) * LA16_CMP_G;
+}
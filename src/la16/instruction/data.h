@@ -30,6 +30,17 @@
 enum LA16_IO_PORT
 {
     LA16_IO_PORT_SERIAL = 0b00000000,
+    LA16_IO_PORT_SERIAL_STATUS = 0b00000001,
+    LA16_IO_PORT_BLOCK_SECTOR = 0b00010000,
+    LA16_IO_PORT_BLOCK_ADDR = 0b00010001,
+    LA16_IO_PORT_BLOCK_CMD = 0b00010010,
+    LA16_IO_PORT_BLOCK_COUNT = 0b00010011,
+    LA16_IO_PORT_DMA_RING = 0b00100000,
+    LA16_IO_PORT_DMA_SIZE = 0b00100001,
+    LA16_IO_PORT_DMA_DOORBELL = 0b00100010,
+    LA16_IO_PORT_DMA_STATUS = 0b00100011,
+    LA16_IO_PORT_IPI = 0b00110000,
+    LA16_IO_PORT_IPI_MAILBOX = 0b00111000,  /* one per core from here on */
 };
 
 void la16_op_push_ext(la16_core_t core, unsigned short val);
@@ -46,5 +57,8 @@ void la16_op_in(la16_core_t core);
 void la16_op_out(la16_core_t core);
 void la16_op_push(la16_core_t core);
 void la16_op_pop(la16_core_t core);
+void la16_op_mcpy(la16_core_t core);
+void la16_op_mset(la16_core_t core);
+void la16_op_mcmp(la16_core_t core);
 
 #endif /* LA16_INSTRUCTION_DATA_H */
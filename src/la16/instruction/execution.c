@@ -152,3 +152,129 @@ void la16_op_ret(la16_core_t core)
     la16_op_pop_ext(core, core->rl[LA16_REGISTER_CF]);
     la16_op_pop_ext(core, core->rl[LA16_REGISTER_PC]);
 }
+
+/* registers behind each bit of a save mask, lowest bit first */
+static const unsigned char la16_call_save_group[5][2] = {
+    { LA16_REGISTER_CF, LA16_REGISTER_CF },
+    { LA16_REGISTER_R0, LA16_REGISTER_R6 },
+    { LA16_REGISTER_R7, LA16_REGISTER_R12 },
+    { LA16_REGISTER_R13, LA16_REGISTER_R18 },
+    { LA16_REGISTER_R19, LA16_REGISTER_R24 },
+};
+
+void la16_op_blm(la16_core_t core)
+{
+    /* a missing mask saves nothing but pc and fp */
+    unsigned short mask = *(core->op.param[1]) & LA16_CALL_SAVE_ALL;
+
+    la16_op_push_ext(core, *core->rl[LA16_REGISTER_PC]);
+    for(unsigned char g = 0; g < 5; g++)
+    {
+        if(mask & (1 << g))
+        {
+            for(unsigned char r = la16_call_save_group[g][0]; r <= la16_call_save_group[g][1]; r++)
+            {
+                la16_op_push_ext(core, *core->rl[r]);
+            }
+        }
+    }
+
+    /* the mask goes into the frame so retm knows what to restore */
+    la16_op_push_ext(core, mask);
+    la16_op_push_ext(core, *core->rl[LA16_REGISTER_FP]);
+    *(core->fp) = *(core->sp);
+    *(core->pc) = *(core->op.param[0]) - 4;
+}
+
+void la16_op_retm(la16_core_t core)
+{
+    unsigned short mask = 0;
+
+    *(core->sp) = *(core->fp);
+    la16_op_pop_ext(core, core->rl[LA16_REGISTER_FP]);
+    la16_op_pop_ext(core, &mask);
+    for(signed char g = 4; g >= 0; g--)
+    {
+        if(mask & (1 << g))
+        {
+            for(signed char r = la16_call_save_group[g][1]; r >= la16_call_save_group[g][0]; r--)
+            {
+                la16_op_pop_ext(core, core->rl[r]);
+            }
+        }
+    }
+    la16_op_pop_ext(core, core->rl[LA16_REGISTER_PC]);
+}
+
+/* compares like cmp, but hands the flags back instead of setting cf */
+static unsigned short la16_op_bcmp(la16_core_t core)
+{
+    signed short a;
+    signed short b;
+    if(core->op.mode == LA16_PARAMETER_CODING_COMBINATION_IMM8_IMM8)
+    {
+        a = (signed short)*(core->rl[core->op.reg[0]]);
+        b = (signed short)core->op.imm[1];
+    }
+    else
+    {
+        a = (signed short)*(core->op.param[0]);
+        b = (signed short)*(core->op.param[1]);
+    }
+
+    return (a == b) * LA16_CMP_Z | (a <  b) * LA16_CMP_L | (a >  b) * LA16_CMP_G;
+}
+
+static void la16_op_branch(la16_core_t core)
+{
+    signed short offset = (core->op.mode == LA16_PARAMETER_CODING_COMBINATION_IMM8_IMM8) ? (signed char)core->op.imm[0] : core->op.disp;
+    *(core->pc) += offset * 4 - 4;
+}
+
+void la16_op_beq(la16_core_t core)
+{
+    if(la16_op_bcmp(core) & LA16_CMP_Z)
+    {
+        la16_op_branch(core);
+    }
+}
+
+void la16_op_bne(la16_core_t core)
+{
+    if(!(la16_op_bcmp(core) & LA16_CMP_Z))
+    {
+        la16_op_branch(core);
+    }
+}
+
+void la16_op_blt(la16_core_t core)
+{
+    if(la16_op_bcmp(core) & LA16_CMP_L)
+    {
+        la16_op_branch(core);
+    }
+}
+
+void la16_op_bgt(la16_core_t core)
+{
+    if(la16_op_bcmp(core) & LA16_CMP_G)
+    {
+        la16_op_branch(core);
+    }
+}
+
+void la16_op_ble(la16_core_t core)
+{
+    if(la16_op_bcmp(core) & (LA16_CMP_L | LA16_CMP_Z))
+    {
+        la16_op_branch(core);
+    }
+}
+
+void la16_op_bge(la16_core_t core)
+{
+    if(la16_op_bcmp(core) & (LA16_CMP_G | LA16_CMP_Z))
+    {
+        la16_op_branch(core);
+    }
+}
@@ -37,5 +37,13 @@ void la16_op_jle(la16_core_t core);
 void la16_op_jge(la16_core_t core);
 void la16_op_bl(la16_core_t core);
 void la16_op_ret(la16_core_t core);
+void la16_op_blm(la16_core_t core);
+void la16_op_retm(la16_core_t core);
+void la16_op_beq(la16_core_t core);
+void la16_op_bne(la16_core_t core);
+void la16_op_blt(la16_core_t core);
+void la16_op_bgt(la16_core_t core);
+void la16_op_ble(la16_core_t core);
+void la16_op_bge(la16_core_t core);
 
 #endif /* LA16_INSTRUCTION_EXECUTION_H */
@@ -41,6 +41,7 @@ void la16_op_int(la16_core_t core)
     }
 
     /* setting elevation backup  */
+    unsigned short elb_backup = *(core->elb);
     *(core->elb) = *(core->el);
 
     /* crafting stack pointer backup */
@@ -57,6 +58,29 @@ void la16_op_int(la16_core_t core)
         }
     }
 
+    /* nothing can still be inside a handler when el0 gets interrupted */
+    if(*(core->el) == LA16_CORE_MODE_EL0)
+    {
+        core->bank.depth = 0;
+    }
+
+    /* the outermost interrupt banks the registers it interrupted */
+    if(core->bank.depth++ == 0)
+    {
+        for(unsigned char i = 0; i < LA16_BANK_REG_CNT; i++)
+        {
+            core->bank.reg[i] = *(core->rl[i]);
+        }
+        core->bank.el = *(core->el);
+        core->bank.elb = elb_backup;
+
+        /* entering the handler with a fresh frame like bl would */
+        *(core->el) = LA16_CORE_MODE_EL1;
+        *(core->fp) = *(core->sp);
+        *(core->pc) = ih_paddr - 4;
+        return;
+    }
+
     /* switching to kernel elevation level */
     *(core->el) = LA16_CORE_MODE_EL1;
 
@@ -82,10 +106,38 @@ void la16_op_intset(la16_core_t core)
 
     /* setting interruption handler, to clear it use 0x0 */
     core->machine->int_handler[*(core->op.param[0])] = *(core->op.param[1]);
+
+    /* cores may have this vector parked or sleep in wfi waiting on it */
+    if(*(core->op.param[1]) != 0x0)
+    {
+        for(unsigned char i = 0; i < LA16_MACHINE_CORE_CNT; i++)
+        {
+            la16_core_wake(core->machine->core[i]);
+        }
+    }
 }
 
 void la16_op_intret(la16_core_t core)
 {
+    /* returning from the outermost interrupt swaps the banked registers back */
+    if(core->bank.depth == 1)
+    {
+        core->bank.depth = 0;
+        for(unsigned char i = 0; i < LA16_BANK_REG_CNT; i++)
+        {
+            *(core->rl[i]) = core->bank.reg[i];
+        }
+        *(core->el) = core->bank.el;
+        *(core->elb) = core->bank.elb;
+        return;
+    }
+
+    /* a nested interrupt returns from the stack */
+    if(core->bank.depth > 1)
+    {
+        core->bank.depth--;
+    }
+
     /* invoking return */
     la16_op_ret(core);
 
@@ -95,3 +147,81 @@ void la16_op_intret(la16_core_t core)
     /* setting elevation back to before */
     *(core->el) = *(core->elb);
 }
+
+void la16_op_wfi(la16_core_t core)
+{
+    /* checking if we run in user land */
+    if(*(core->el) == LA16_CORE_MODE_EL0)
+    {
+        core->term = LA16_TERM_FLAG_PERMISSION;
+        return;
+    }
+
+    /* sleeping till an interrupt is pending, then taking it */
+    la16_core_wait(core);
+}
+
+/* finds the banked copy of a register, rr is not banked and stays live */
+static unsigned short *la16_op_bank_reg(la16_core_t core,
+                                        unsigned short reg)
+{
+    if(reg < LA16_BANK_REG_CNT)
+    {
+        return &core->bank.reg[reg];
+    }
+
+    switch(reg)
+    {
+        case LA16_REGISTER_RR:
+            return core->rl[LA16_REGISTER_RR];
+        case LA16_REGISTER_EL:
+            return &core->bank.el;
+        case LA16_REGISTER_ELB:
+            return &core->bank.elb;
+        default:
+            return NULL;
+    }
+}
+
+void la16_op_bnkget(la16_core_t core)
+{
+    /* checking if we run in user land */
+    if(*(core->el) == LA16_CORE_MODE_EL0)
+    {
+        core->term = LA16_TERM_FLAG_PERMISSION;
+        return;
+    }
+
+    /* the banked register is named by a register, an immediate gives its number */
+    unsigned short reg = (core->op.mode == LA16_PARAMETER_CODING_COMBINATION_REG_REG) ? core->op.reg[1] : core->op.imm[1];
+    unsigned short *banked = la16_op_bank_reg(core, reg);
+    if(banked == NULL)
+    {
+        core->term = LA16_TERM_FLAG_BAD_ACCESS;
+        return;
+    }
+
+    *(core->op.param[0]) = *banked;
+}
+
+void la16_op_bnkset(la16_core_t core)
+{
+    /* checking if we run in user land */
+    if(*(core->el) == LA16_CORE_MODE_EL0)
+    {
+        core->term = LA16_TERM_FLAG_PERMISSION;
+        return;
+    }
+
+    /* the banked register is named by a register, an immediate gives its number */
+    unsigned short reg = (core->op.mode == LA16_PARAMETER_CODING_COMBINATION_REG_REG ||
+                          core->op.mode == LA16_PARAMETER_CODING_COMBINATION_REG_IMM16) ? core->op.reg[0] : core->op.imm[0];
+    unsigned short *banked = la16_op_bank_reg(core, reg);
+    if(banked == NULL)
+    {
+        core->term = LA16_TERM_FLAG_BAD_ACCESS;
+        return;
+    }
+
+    *banked = *(core->op.param[1]);
+}
@@ -30,5 +30,8 @@
 void la16_op_int(la16_core_t core);
 void la16_op_intset(la16_core_t core);
 void la16_op_intret(la16_core_t core);
+void la16_op_wfi(la16_core_t core);
+void la16_op_bnkget(la16_core_t core);
+void la16_op_bnkset(la16_core_t core);
 
 #endif /* LA16_INSTRUCTION_IC_H */
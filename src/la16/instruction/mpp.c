@@ -193,6 +193,40 @@ unsigned char la16_mpp_write8(la16_core_t core,
     return 0b0;
 }
 
+unsigned char la16_mpp_range(la16_core_t core,
+                             unsigned short uaddr,
+                             unsigned short len,
+                             unsigned char vprot)
+{
+    /* the whole range has to be backed by memory, without wrapping around */
+    unsigned long end = (unsigned long)uaddr + len;
+    if(end > core->machine->memory->memory_size)
+    {
+        return 0b0;
+    }
+
+    /* kernel level accesses physical memory directly */
+    if(*(core->el) == LA16_CORE_MODE_EL1)
+    {
+        return 0b1;
+    }
+
+    /* checking each page the range touches once instead of every byte */
+    for(unsigned long run = uaddr; run < end; run = (run / LA16_MEMORY_PAGE_SIZE + 1) * LA16_MEMORY_PAGE_SIZE)
+    {
+        mpp_address_t maddr = {};
+        maddr.virt_addr = (unsigned short)run;
+
+        if(!(la16_mpp_address(core, &maddr) &&
+            ((maddr.virt_page_flags & vprot) == vprot)))
+        {
+            return 0b0;
+        }
+    }
+
+    return 0b1;
+}
+
 void la16_op_ppcnt(la16_core_t core)
 {
     /* checking if running in user level which cannot use this opcode */
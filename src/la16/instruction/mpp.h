@@ -33,6 +33,7 @@ unsigned char la16_mpp_read(la16_core_t core, unsigned short uaddr, unsigned sho
 unsigned char la16_mpp_write(la16_core_t core, unsigned short uaddr, unsigned short val);
 unsigned char la16_mpp_read8(la16_core_t core, unsigned short uaddr, unsigned char *val);
 unsigned char la16_mpp_write8(la16_core_t core, unsigned short uaddr, unsigned char val);
+unsigned char la16_mpp_range(la16_core_t core, unsigned short uaddr, unsigned short len, unsigned char vprot);
 
 void la16_op_ppcnt(la16_core_t core);
 void la16_op_ppktrrset(la16_core_t core);
@@ -0,0 +1,90 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <la16/ipi.h>
+#include <la16/machine.h>
+#include <la16/instruction/data.h>
+
+la16_ipi_t *la16_ipi_alloc(la16_machine_t *machine)
+{
+    la16_ipi_t *ipi = calloc(1, sizeof(la16_ipi_t));
+    ipi->machine = machine;
+    return ipi;
+}
+
+void la16_ipi_dealloc(la16_ipi_t *ipi)
+{
+    free(ipi);
+}
+
+static void la16_ipi_port_in(void *device,
+                             la16_core_t core,
+                             unsigned short port,
+                             unsigned short *val)
+{
+    la16_ipi_t *ipi = device;
+
+    if(port == LA16_IO_PORT_IPI)
+    {
+        *val = core->id;
+        return;
+    }
+
+    /* taking everything posted to the mailbox at once */
+    la16_core_t target = ipi->machine->core[port - LA16_IO_PORT_IPI_MAILBOX];
+    *val = atomic_exchange(&target->mailbox, 0);
+}
+
+static void la16_ipi_port_out(void *device,
+                              la16_core_t core,
+                              unsigned short port,
+                              unsigned short val)
+{
+    la16_ipi_t *ipi = device;
+
+    if(port == LA16_IO_PORT_IPI)
+    {
+        unsigned char id = val >> 8;
+        if(id < LA16_MACHINE_CORE_CNT)
+        {
+            la16_core_raise(ipi->machine->core[id], val & 0xFF);
+        }
+        return;
+    }
+
+    la16_core_t target = ipi->machine->core[port - LA16_IO_PORT_IPI_MAILBOX];
+    atomic_fetch_or(&target->mailbox, val);
+}
+
+void la16_ipi_register(la16_ipi_t *ipi,
+                       la16_bus_t *bus)
+{
+    la16_bus_register(bus, LA16_IO_PORT_IPI, ipi, la16_ipi_port_in, la16_ipi_port_out);
+    for(unsigned short i = 0; i < LA16_MACHINE_CORE_CNT; i++)
+    {
+        la16_bus_register(bus, LA16_IO_PORT_IPI_MAILBOX + i, ipi, la16_ipi_port_in, la16_ipi_port_out);
+    }
+}
@@ -0,0 +1,52 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LA16_IPI_H
+#define LA16_IPI_H
+
+#include <la16/core.h>
+#include <la16/bus.h>
+
+/*
+ * out to the ipi port posts the vector in the low byte to the
+ * pending interrupts of the core in the high byte, in reads the
+ * number of the core executing it
+ *
+ * every core has a mailbox word at LA16_IO_PORT_IPI_MAILBOX plus
+ * its number, out sets bits in it and in takes all bits set so far
+ * clearing it, so any number of senders can post work for a core
+ * without a lock and without it spinning on shared memory
+ */
+struct la16_ipi
+{
+    la16_machine_t *machine;
+};
+
+typedef struct la16_ipi la16_ipi_t;
+
+la16_ipi_t *la16_ipi_alloc(la16_machine_t *machine);
+void la16_ipi_dealloc(la16_ipi_t *ipi);
+void la16_ipi_register(la16_ipi_t *ipi, la16_bus_t *bus);
+
+#endif /* LA16_IPI_H */
@@ -0,0 +1,121 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <la16/irq.h>
+
+void la16_irq_init(la16_irq_queue_t *queue)
+{
+    for(unsigned int i = 0; i < LA16_IRQ_QUEUE_SIZE; i++)
+    {
+        atomic_init(&queue->slot[i].seq, i);
+    }
+    atomic_init(&queue->tail, 0);
+    queue->head = 0;
+}
+
+bool la16_irq_post(la16_irq_queue_t *queue, unsigned short vector)
+{
+    unsigned int pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    la16_irq_slot_t *slot;
+
+    while(1)
+    {
+        slot = &queue->slot[pos & LA16_IRQ_QUEUE_MASK];
+        int diff = (int)(atomic_load_explicit(&slot->seq, memory_order_acquire) - pos);
+
+        if(diff == 0)
+        {
+            /* slot is free for this position, claiming it */
+            if(atomic_compare_exchange_weak_explicit(&queue->tail, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if(diff < 0)
+        {
+            /* the core has not taken the slot a lap ago yet, queue is full */
+            return false;
+        }
+        else
+        {
+            /* another producer claimed it first */
+            pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+        }
+    }
+
+    slot->vector = vector;
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    return true;
+}
+
+bool la16_irq_peek(la16_irq_queue_t *queue, unsigned short *vector)
+{
+    la16_irq_slot_t *slot = &queue->slot[queue->head & LA16_IRQ_QUEUE_MASK];
+
+    /* checking if the slot was published already */
+    if(atomic_load_explicit(&slot->seq, memory_order_acquire) != queue->head + 1)
+    {
+        return false;
+    }
+
+    *vector = slot->vector;
+    return true;
+}
+
+void la16_irq_take(la16_irq_queue_t *queue)
+{
+    la16_irq_slot_t *slot = &queue->slot[queue->head & LA16_IRQ_QUEUE_MASK];
+
+    /* handing the slot back to producers for the next lap */
+    atomic_store_explicit(&slot->seq, queue->head + LA16_IRQ_QUEUE_SIZE, memory_order_release);
+    queue->head++;
+}
+
+void la16_irq_park(la16_irq_queue_t *queue,
+                   unsigned short vector)
+{
+    if(vector >= LA16_IRQ_PARKED_MAX)
+    {
+        return;
+    }
+
+    /* a vector parked already stays one pending interrupt */
+    unsigned int bit = 1u << (vector % 32);
+    if(!(queue->parked[vector / 32] & bit))
+    {
+        queue->parked[vector / 32] |= bit;
+        queue->parked_cnt++;
+    }
+}
+
+void la16_irq_unpark(la16_irq_queue_t *queue,
+                     unsigned short vector)
+{
+    unsigned int bit = 1u << (vector % 32);
+    if(vector < LA16_IRQ_PARKED_MAX && (queue->parked[vector / 32] & bit))
+    {
+        queue->parked[vector / 32] &= ~bit;
+        queue->parked_cnt--;
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LA16_IRQ_H
+#define LA16_IRQ_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/*
+ * bounded lock-free queue of pending interrupt vectors, any thread
+ * posts into it, only the thread of the owning core takes from it,
+ * each slot carries a sequence telling if it is free or published
+ */
+#define LA16_IRQ_QUEUE_SIZE         64          /* power of two */
+#define LA16_IRQ_QUEUE_MASK         (LA16_IRQ_QUEUE_SIZE - 1)
+
+/*
+ * vectors taken while the guest had no handler for them are parked
+ * as one bit each, making device interrupts level triggered, the
+ * core delivers them once a handler got set, vectors above get dropped
+ */
+#define LA16_IRQ_PARKED_MAX         0x100
+
+typedef struct {
+    _Atomic unsigned int seq;
+    unsigned short vector;
+} la16_irq_slot_t;
+
+typedef struct {
+    la16_irq_slot_t slot[LA16_IRQ_QUEUE_SIZE];
+    _Atomic unsigned int tail;              /* next slot a producer claims */
+    unsigned int head;                      /* next slot the core takes, only touched by the core */
+
+    /* parked vectors, only touched by the core */
+    unsigned int parked[LA16_IRQ_PARKED_MAX / 32];
+    unsigned int parked_cnt;
+} la16_irq_queue_t;
+
+void la16_irq_init(la16_irq_queue_t *queue);
+bool la16_irq_post(la16_irq_queue_t *queue, unsigned short vector);
+bool la16_irq_peek(la16_irq_queue_t *queue, unsigned short *vector);
+void la16_irq_take(la16_irq_queue_t *queue);
+void la16_irq_park(la16_irq_queue_t *queue, unsigned short vector);
+void la16_irq_unpark(la16_irq_queue_t *queue, unsigned short vector);
+
+/* fast path of the core, a claimed slot may still be getting published */
+static inline bool la16_irq_pending(la16_irq_queue_t *queue)
+{
+    return atomic_load_explicit(&queue->tail, memory_order_relaxed) != queue->head ||
+           queue->parked_cnt != 0;
+}
+
+#endif /* LA16_IRQ_H */
@@ -28,25 +28,65 @@
 la16_machine_t *la16_machine_alloc(unsigned short memory_size)
 {
     // Allocate base
-    la16_machine_t *machine = malloc(sizeof(la16_machine_t));
+    la16_machine_t *machine = calloc(1, sizeof(la16_machine_t));
 
     // Allocate memory
     machine->memory = la16_memory_alloc(memory_size);
 
     // Now allocate the cores
-    for(unsigned char i = 0; i < 4; i++)
+    for(unsigned char i = 0; i < LA16_MACHINE_CORE_CNT; i++)
     {
         machine->core[i] = la16_core_alloc();
         machine->core[i]->machine = machine;
+        machine->core[i]->id = i;
     }
 
+    // Allocate the io bus and the devices on it
+    machine->bus = la16_bus_alloc();
+
+    // Allocate the serial device, its input interrupts the first core
+    machine->serial = la16_serial_alloc(machine);
+    la16_serial_register(machine->serial, machine->bus);
+
+    // Allocate the dma engine, it moves data for the other devices
+    machine->dma = la16_dma_alloc(machine);
+    la16_dma_register(machine->dma, machine->bus);
+
+    // Allocate the ipi device, cores signal each other through it
+    machine->ipi = la16_ipi_alloc(machine);
+    la16_ipi_register(machine->ipi, machine->bus);
+
     return machine;
 }
 
 void la16_machine_dealloc(la16_machine_t *machine)
 {
+    // Stop the cores the guest resumed, they use everything below
+    for(unsigned char i = 0; i < LA16_MACHINE_CORE_CNT; i++)
+    {
+        la16_core_stop(machine->core[i]);
+    }
+
+    // Deallocate the ipi device
+    la16_ipi_dealloc(machine->ipi);
+
+    // Deallocate the dma engine next, it works on the other devices
+    la16_dma_dealloc(machine->dma);
+
+    // Deallocate the serial device, its reader raises on the cores
+    la16_serial_dealloc(machine->serial);
+
+    // Deallocate the block device, writing the disk back
+    if(machine->block != NULL)
+    {
+        la16_block_dealloc(machine->block);
+    }
+
+    // Deallocate the io bus
+    la16_bus_dealloc(machine->bus);
+
     // Deallocate cores
-    for(unsigned char i = 0; i < 4; i++)
+    for(unsigned char i = 0; i < LA16_MACHINE_CORE_CNT; i++)
     {
         la16_core_dealloc(machine->core[i]);
     }
@@ -57,3 +97,22 @@ void la16_machine_dealloc(la16_machine_t *machine)
     // Deallocate base
     free(machine);
 }
+
+unsigned char la16_machine_attach_block(la16_machine_t *machine,
+                                        const char *path)
+{
+    // A machine has one disk
+    if(machine->block != NULL)
+    {
+        return 0;
+    }
+
+    machine->block = la16_block_alloc(machine, path);
+    if(machine->block == NULL)
+    {
+        return 0;
+    }
+
+    la16_block_register(machine->block, machine->bus);
+    return 1;
+}
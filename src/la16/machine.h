@@ -27,11 +27,23 @@
 
 #include <la16/core.h>
 #include <la16/memory.h>
+#include <la16/serial.h>
+#include <la16/bus.h>
+#include <la16/block.h>
+#include <la16/dma.h>
+#include <la16/ipi.h>
+
+#define LA16_MACHINE_CORE_CNT       4
 
 struct la16_machine
 {
-    la16_core_t core[4];
+    la16_core_t core[LA16_MACHINE_CORE_CNT];
     la16_memory_t *memory;
+    la16_serial_t *serial;
+    la16_bus_t *bus;                        /* devices behind in and out */
+    la16_block_t *block;                    /* block device, NULL without a disk */
+    la16_dma_t *dma;
+    la16_ipi_t *ipi;                        /* interrupts and mailboxes between the cores */
     unsigned short int_handler[0xFFFF];
 };
 
@@ -39,5 +51,6 @@ typedef struct la16_machine la16_machine_t;
 
 la16_machine_t *la16_machine_alloc(unsigned short memory_size);
 void la16_machine_dealloc(la16_machine_t *machine);
+unsigned char la16_machine_attach_block(la16_machine_t *machine, const char *path);
 
 #endif /* LA16_MACHINE_H */
@@ -0,0 +1,393 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <la16/serial.h>
+#include <la16/machine.h>
+#include <la16/instruction/data.h>
+
+/* terminal settings a fatal signal has to put back */
+static struct termios la16_serial_termios;
+
+/* hands everything buffered to the host, the lock has to be held */
+static void la16_serial_flush_locked(la16_serial_t *serial)
+{
+    unsigned short off = 0;
+    while(off < serial->len)
+    {
+        ssize_t written = write(STDOUT_FILENO, &serial->buffer[off], serial->len - off);
+        if(written <= 0)
+        {
+            break;
+        }
+        off += written;
+    }
+    serial->len = 0;
+}
+
+static void *la16_serial_flusher(void *arg)
+{
+    la16_serial_t *serial = arg;
+
+    pthread_mutex_lock(&serial->lock);
+    while(!serial->stop)
+    {
+        // Sleeping until there is something to flush
+        if(serial->len == 0)
+        {
+            pthread_cond_wait(&serial->cond, &serial->lock);
+            continue;
+        }
+
+        // Giving the guest a moment to complete its line
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += LA16_SERIAL_FLUSH_DELAY_NS;
+        if(deadline.tv_nsec >= 1000000000)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&serial->cond, &serial->lock, &deadline);
+
+        la16_serial_flush_locked(serial);
+    }
+    pthread_mutex_unlock(&serial->lock);
+
+    return NULL;
+}
+
+static void la16_serial_restore(int sig)
+{
+    tcsetattr(STDIN_FILENO, TCSANOW, &la16_serial_termios);
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+/* puts what the host sent into the ring, waiting for the guest when it is full */
+static void la16_serial_input(la16_serial_t *serial,
+                              const unsigned char *buf,
+                              size_t len)
+{
+    pthread_mutex_lock(&serial->input_lock);
+    for(size_t i = 0; i < len && !serial->stop; i++)
+    {
+        while(serial->input_len == LA16_SERIAL_INPUT_SIZE && !serial->stop)
+        {
+            pthread_cond_wait(&serial->input_cond, &serial->input_lock);
+        }
+        serial->input[(serial->input_head + serial->input_len) % LA16_SERIAL_INPUT_SIZE] = buf[i];
+        serial->input_len++;
+    }
+    pthread_cond_broadcast(&serial->input_cond);
+    pthread_mutex_unlock(&serial->input_lock);
+
+    la16_core_raise(serial->machine->core[0], LA16_INT_SERIAL);
+}
+
+static void *la16_serial_reader(void *arg)
+{
+    la16_serial_t *serial = arg;
+
+    // Regular files cannot be watched, they never block either
+    int ep = epoll_create1(0);
+    struct epoll_event ev = { .events = EPOLLIN };
+    ev.data.fd = STDIN_FILENO;
+    unsigned char watched = epoll_ctl(ep, EPOLL_CTL_ADD, STDIN_FILENO, &ev) == 0;
+    ev.data.fd = serial->wake;
+    epoll_ctl(ep, EPOLL_CTL_ADD, serial->wake, &ev);
+
+    while(!serial->stop)
+    {
+        if(watched)
+        {
+            struct epoll_event events[2];
+            int n = epoll_wait(ep, events, 2, -1);
+            if(n <= 0)
+            {
+                continue;
+            }
+
+            unsigned char ready = 0;
+            for(int i = 0; i < n; i++)
+            {
+                ready |= events[i].data.fd == STDIN_FILENO;
+            }
+            if(!ready)
+            {
+                continue;
+            }
+        }
+
+        unsigned char buf[256];
+        ssize_t len = read(STDIN_FILENO, buf, sizeof(buf));
+        if(len <= 0)
+        {
+            break;
+        }
+        la16_serial_input(serial, buf, len);
+    }
+
+    // Waking a guest that waits for input which will never come
+    pthread_mutex_lock(&serial->input_lock);
+    serial->closed = 1;
+    pthread_cond_broadcast(&serial->input_cond);
+    pthread_mutex_unlock(&serial->input_lock);
+
+    close(ep);
+    return NULL;
+}
+
+la16_serial_t *la16_serial_alloc(la16_machine_t *machine)
+{
+    la16_serial_t *serial = calloc(1, sizeof(la16_serial_t));
+    pthread_mutex_init(&serial->lock, NULL);
+    pthread_cond_init(&serial->cond, NULL);
+    pthread_mutex_init(&serial->input_lock, NULL);
+    pthread_cond_init(&serial->input_cond, NULL);
+    serial->machine = machine;
+    serial->unbuffered = getenv("LA16_SERIAL_UNBUFFERED") != NULL;
+
+    if(!serial->unbuffered)
+    {
+        pthread_create(&serial->flusher, NULL, la16_serial_flusher, serial);
+    }
+
+    // Raw mode once for the whole run instead of around every read
+    if(isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &serial->termios) == 0)
+    {
+        struct termios raw = serial->termios;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+        serial->raw = 1;
+
+        la16_serial_termios = serial->termios;
+        signal(SIGINT, la16_serial_restore);
+        signal(SIGTERM, la16_serial_restore);
+    }
+
+    serial->wake = eventfd(0, 0);
+    pthread_create(&serial->reader, NULL, la16_serial_reader, serial);
+
+    return serial;
+}
+
+void la16_serial_dealloc(la16_serial_t *serial)
+{
+    pthread_mutex_lock(&serial->lock);
+    serial->stop = 1;
+    pthread_cond_signal(&serial->cond);
+    pthread_mutex_unlock(&serial->lock);
+
+    if(!serial->unbuffered)
+    {
+        pthread_join(serial->flusher, NULL);
+    }
+
+    // Stopping the reader, wherever it waits
+    uint64_t one = 1;
+    write(serial->wake, &one, sizeof(one));
+    pthread_mutex_lock(&serial->input_lock);
+    pthread_cond_broadcast(&serial->input_cond);
+    pthread_mutex_unlock(&serial->input_lock);
+    pthread_join(serial->reader, NULL);
+    close(serial->wake);
+
+    if(serial->raw)
+    {
+        tcsetattr(STDIN_FILENO, TCSANOW, &serial->termios);
+        signal(SIGINT, SIG_DFL);
+        signal(SIGTERM, SIG_DFL);
+    }
+
+    la16_serial_flush(serial);
+    pthread_cond_destroy(&serial->input_cond);
+    pthread_mutex_destroy(&serial->input_lock);
+    pthread_cond_destroy(&serial->cond);
+    pthread_mutex_destroy(&serial->lock);
+    free(serial);
+}
+
+void la16_serial_putc(la16_serial_t *serial, unsigned char c)
+{
+    if(serial->unbuffered)
+    {
+        write(STDOUT_FILENO, &c, 1);
+        return;
+    }
+
+    pthread_mutex_lock(&serial->lock);
+
+    serial->buffer[serial->len++] = c;
+
+    if(c == '\n' || serial->len == LA16_SERIAL_BUFFER_SIZE)
+    {
+        la16_serial_flush_locked(serial);
+    }
+    else if(serial->len == 1)
+    {
+        // Waking the flusher, so a line without newline still shows up
+        pthread_cond_signal(&serial->cond);
+    }
+
+    pthread_mutex_unlock(&serial->lock);
+}
+
+void la16_serial_write(la16_serial_t *serial,
+                       const unsigned char *buf,
+                       unsigned short len)
+{
+    if(serial->unbuffered)
+    {
+        write(STDOUT_FILENO, buf, len);
+        return;
+    }
+
+    pthread_mutex_lock(&serial->lock);
+
+    unsigned char newline = 0;
+    for(unsigned short i = 0; i < len; i++)
+    {
+        serial->buffer[serial->len++] = buf[i];
+        newline |= buf[i] == '\n';
+        if(serial->len == LA16_SERIAL_BUFFER_SIZE)
+        {
+            la16_serial_flush_locked(serial);
+        }
+    }
+
+    if(newline)
+    {
+        la16_serial_flush_locked(serial);
+    }
+    else if(serial->len > 0)
+    {
+        pthread_cond_signal(&serial->cond);
+    }
+
+    pthread_mutex_unlock(&serial->lock);
+}
+
+void la16_serial_flush(la16_serial_t *serial)
+{
+    pthread_mutex_lock(&serial->lock);
+    la16_serial_flush_locked(serial);
+    pthread_mutex_unlock(&serial->lock);
+}
+
+unsigned char la16_serial_getc(la16_serial_t *serial, unsigned short *c)
+{
+    pthread_mutex_lock(&serial->input_lock);
+
+    // Waiting like a read on the host would, until input arrives or ends
+    while(serial->input_len == 0 && !serial->closed)
+    {
+        pthread_cond_wait(&serial->input_cond, &serial->input_lock);
+    }
+
+    unsigned char got = serial->input_len > 0;
+    if(got)
+    {
+        *c = serial->input[serial->input_head];
+        serial->input_head = (serial->input_head + 1) % LA16_SERIAL_INPUT_SIZE;
+        serial->input_len--;
+        pthread_cond_broadcast(&serial->input_cond);
+    }
+
+    pthread_mutex_unlock(&serial->input_lock);
+    return got;
+}
+
+/* takes what already arrived without waiting for more */
+unsigned short la16_serial_read(la16_serial_t *serial,
+                                unsigned char *buf,
+                                unsigned short len)
+{
+    pthread_mutex_lock(&serial->input_lock);
+
+    unsigned short got = 0;
+    while(got < len && serial->input_len > 0)
+    {
+        buf[got++] = serial->input[serial->input_head];
+        serial->input_head = (serial->input_head + 1) % LA16_SERIAL_INPUT_SIZE;
+        serial->input_len--;
+    }
+    if(got > 0)
+    {
+        pthread_cond_broadcast(&serial->input_cond);
+    }
+
+    pthread_mutex_unlock(&serial->input_lock);
+    return got;
+}
+
+unsigned short la16_serial_status(la16_serial_t *serial)
+{
+    pthread_mutex_lock(&serial->input_lock);
+    unsigned short status = (serial->input_len > 0) * LA16_SERIAL_STATUS_READY |
+                            (serial->closed && serial->input_len == 0) * LA16_SERIAL_STATUS_CLOSED;
+    pthread_mutex_unlock(&serial->input_lock);
+    return status;
+}
+
+static void la16_serial_port_in(void *device,
+                                la16_core_t core,
+                                unsigned short port,
+                                unsigned short *val)
+{
+    la16_serial_t *serial = device;
+
+    if(port == LA16_IO_PORT_SERIAL_STATUS)
+    {
+        /* polling without waiting */
+        *val = la16_serial_status(serial);
+        return;
+    }
+
+    /* a prompt has to be visible before waiting on input */
+    la16_serial_flush(serial);
+    la16_serial_getc(serial, val);
+}
+
+static void la16_serial_port_out(void *device,
+                                 la16_core_t core,
+                                 unsigned short port,
+                                 unsigned short val)
+{
+    la16_serial_putc(device, (unsigned char)val);
+}
+
+void la16_serial_register(la16_serial_t *serial,
+                          la16_bus_t *bus)
+{
+    la16_bus_register(bus, LA16_IO_PORT_SERIAL, serial, la16_serial_port_in, la16_serial_port_out);
+    la16_bus_register(bus, LA16_IO_PORT_SERIAL_STATUS, serial, la16_serial_port_in, NULL);
+}
@@ -0,0 +1,91 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LA16_SERIAL_H
+#define LA16_SERIAL_H
+
+#include <pthread.h>
+#include <termios.h>
+#include <stdatomic.h>
+#include <la16/core.h>
+#include <la16/bus.h>
+
+#define LA16_SERIAL_BUFFER_SIZE     4096
+#define LA16_SERIAL_FLUSH_DELAY_NS  10000000    /* output waits at most 10ms for more to come */
+#define LA16_SERIAL_INPUT_SIZE      4096
+
+/* bits of the serial status port */
+#define LA16_SERIAL_STATUS_READY    0b01        /* input is waiting to be read */
+#define LA16_SERIAL_STATUS_CLOSED   0b10        /* host input ended */
+
+/*
+ * serial output is collected per machine and handed to the host
+ * in one write on newline, when full, on halt or by the flusher
+ * thread once it sat for a while, LA16_SERIAL_UNBUFFERED writes
+ * every character right away for interactive use
+ *
+ * serial input is read by an epoll driven reader thread into a ring
+ * the guest takes from, every arrival raises LA16_INT_SERIAL on the
+ * first core, a terminal is put into raw mode once for the whole run
+ */
+struct la16_serial
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;                    /* wakes the flusher on pending output and on stop */
+    pthread_t flusher;
+    unsigned char buffer[LA16_SERIAL_BUFFER_SIZE];
+    unsigned short len;
+    unsigned char unbuffered;
+    _Atomic unsigned char stop;             /* the reader checks it outside of any lock */
+
+    /* input */
+    pthread_mutex_t input_lock;
+    pthread_cond_t input_cond;              /* signals input, free space and stop */
+    pthread_t reader;
+    int wake;                               /* eventfd stopping the reader */
+    unsigned char input[LA16_SERIAL_INPUT_SIZE];
+    unsigned short input_head;
+    unsigned short input_len;
+    unsigned char closed;
+    unsigned char raw;
+    struct termios termios;                 /* terminal settings to restore */
+    la16_machine_t *machine;
+};
+
+typedef struct la16_serial la16_serial_t;
+
+la16_serial_t *la16_serial_alloc(la16_machine_t *machine);
+void la16_serial_dealloc(la16_serial_t *serial);
+
+void la16_serial_putc(la16_serial_t *serial, unsigned char c);
+void la16_serial_write(la16_serial_t *serial, const unsigned char *buf, unsigned short len);
+void la16_serial_flush(la16_serial_t *serial);
+
+unsigned char la16_serial_getc(la16_serial_t *serial, unsigned short *c);
+unsigned short la16_serial_read(la16_serial_t *serial, unsigned char *buf, unsigned short len);
+unsigned short la16_serial_status(la16_serial_t *serial);
+
+void la16_serial_register(la16_serial_t *serial, la16_bus_t *bus);
+
+#endif /* LA16_SERIAL_H */
@@ -0,0 +1,119 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <la16/timer.h>
+
+static void *la16_timer_wall(void *arg)
+{
+    la16_timer_t *timer = arg;
+
+    struct pollfd fds[2] = {
+        { .fd = timer->fd, .events = POLLIN },
+        { .fd = timer->wake, .events = POLLIN },
+    };
+
+    while(1)
+    {
+        if(poll(fds, 2, -1) <= 0)
+        {
+            continue;
+        }
+        if(fds[1].revents & POLLIN)
+        {
+            break;
+        }
+
+        // Expirations that piled up raise just once, the vector is pending either way
+        uint64_t expirations;
+        if(read(timer->fd, &expirations, sizeof(expirations)) == sizeof(expirations))
+        {
+            la16_core_raise(timer->core, atomic_load_explicit(&timer->vector, memory_order_relaxed));
+        }
+    }
+
+    return NULL;
+}
+
+la16_timer_t *la16_timer_alloc(la16_core_t core)
+{
+    la16_timer_t *timer = calloc(1, sizeof(la16_timer_t));
+    timer->core = core;
+    timer->fd = -1;
+    timer->wake = -1;
+    return timer;
+}
+
+void la16_timer_dealloc(la16_timer_t *timer)
+{
+    if(timer->running)
+    {
+        uint64_t one = 1;
+        write(timer->wake, &one, sizeof(one));
+        pthread_join(timer->thread, NULL);
+        close(timer->wake);
+        close(timer->fd);
+    }
+
+    free(timer);
+}
+
+void la16_timer_set(la16_timer_t *timer,
+                    unsigned short period,
+                    unsigned short config)
+{
+    unsigned char source = config >> 8;
+    atomic_store_explicit(&timer->vector, config & 0xFF, memory_order_relaxed);
+
+    // Either source replaces the other
+    timer->period = (source == LA16_TIMER_SOURCE_RETIRED) ? (unsigned long)period * LA16_CORE_SLICE : 0;
+    timer->left = timer->period;
+
+    unsigned long ms = (source == LA16_TIMER_SOURCE_WALL) ? period : 0;
+    if(ms != 0 && !timer->running)
+    {
+        timer->fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        timer->wake = eventfd(0, EFD_CLOEXEC);
+        if(timer->fd == -1 || timer->wake == -1)
+        {
+            return;
+        }
+        pthread_create(&timer->thread, NULL, la16_timer_wall, timer);
+        timer->running = 1;
+    }
+
+    if(timer->running)
+    {
+        struct itimerspec spec = {};
+        spec.it_value.tv_sec = ms / 1000;
+        spec.it_value.tv_nsec = (ms % 1000) * 1000000;
+        spec.it_interval = spec.it_value;
+        timerfd_settime(timer->fd, 0, &spec, NULL);
+    }
+}
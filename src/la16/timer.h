@@ -0,0 +1,82 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 cr4zyengineer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LA16_TIMER_H
+#define LA16_TIMER_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <la16/core.h>
+
+/*
+ * crtimeset period, source | vector
+ *
+ * the high byte of the second operand picks what the period counts,
+ * the low byte is the interrupt vector raised each time it ran out,
+ * a period of 0 stops the timer
+ */
+#define LA16_TIMER_SOURCE_RETIRED   0x00        /* slices of LA16_CORE_SLICE retired instructions */
+#define LA16_TIMER_SOURCE_WALL      0x01        /* milliseconds of host time */
+
+struct la16_timer
+{
+    /* retired instruction source, only touched by the core thread */
+    unsigned long period;
+    unsigned long left;
+
+    /* wall clock source, a timerfd watched by its own thread */
+    int fd;
+    int wake;                               /* eventfd stopping the thread */
+    pthread_t thread;
+    unsigned char running;
+
+    _Atomic unsigned short vector;
+    la16_core_t core;
+};
+
+la16_timer_t *la16_timer_alloc(la16_core_t core);
+void la16_timer_dealloc(la16_timer_t *timer);
+
+void la16_timer_set(la16_timer_t *timer, unsigned short period, unsigned short config);
+
+/* counts down what a slice retired, raising the interrupt once it ran out */
+static inline void la16_timer_retire(la16_timer_t *timer,
+                                     unsigned long ran)
+{
+    if(timer->period == 0)
+    {
+        return;
+    }
+
+    if(ran < timer->left)
+    {
+        timer->left -= ran;
+        return;
+    }
+
+    timer->left = timer->period;
+    la16_core_raise(timer->core, atomic_load_explicit(&timer->vector, memory_order_relaxed));
+}
+
+#endif /* LA16_TIMER_H */
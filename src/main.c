@@ -34,7 +34,7 @@ void print_usage(int argc, char **argv)
     /* checking if we have atleast one arg to print the usage */
     if(argc >= 1)
     {
-        fprintf(stderr, "Usage: %s\n\t-c <l16 files> : compiling a la16 boot image out of la16 assembly files\n\t-r <image file> : running a image file\n", argv[0]);
+        fprintf(stderr, "Usage: %s\n\t-c [-O] <l16 files> : compiling a la16 boot image out of la16 assembly files\n\t-a [-O] <l16 files> : assembling each la16 assembly file into a relocatable object file\n\t-O : optimizing the code call expansions generate\n\t-l <object files> : linking relocatable object files into a la16 boot image\n\t-r <image file> [disk file] : running a image file, the disk file backs the block device\n", argv[0]);
     }
 }
 
@@ -51,16 +51,37 @@ int main(int argc, char *argv[])
     }
 
     /* checking if its compilation */
-    if(strcmp(argv[1], "-c") == 0)
+    if(strcmp(argv[1], "-c") == 0 || strcmp(argv[1], "-a") == 0 || strcmp(argv[1], "-l") == 0)
     {
+        /* optimization only matters while assembling */
+        int first = 2;
+        bool optimize = false;
+        if(argv[1][1] != 'l' && argc > 2 && strcmp(argv[2], "-O") == 0)
+        {
+            optimize = true;
+            first++;
+        }
+
         /* gettu*/
-        char **files = calloc(sizeof(char*), argc - 2);
-        for(int i = 0; i < (argc - 2); i++)
+        int file_cnt = argc - first;
+        char **files = calloc(sizeof(char*), file_cnt);
+        for(int i = 0; i < file_cnt; i++)
+        {
+            files[i] = strdup(argv[i + first]);
+        }
+        if(argv[1][1] == 'c')
+        {
+            compile_files(files, file_cnt, optimize);
+        }
+        else if(argv[1][1] == 'a')
+        {
+            compile_objects(files, file_cnt, optimize);
+        }
+        else
         {
-            files[i] = strdup(argv[i + 2]);
+            link_files(files, file_cnt);
         }
-        compile_files(files, argc - 2);
-        for(int i = 0; i < (argc - 2); i++)
+        for(int i = 0; i < file_cnt; i++)
         {
             free(files[i]);
         }
@@ -78,9 +99,23 @@ int main(int argc, char *argv[])
         /* loading boot image into memory of virtual machine */
         if(!la16_memory_load_image(machine->memory, argv[2]))
         {
+            la16_machine_dealloc(machine);
             return 1;
         }
 
+        /* attaching the disk as block device */
+        if(argc > 3)
+        {
+            if(!la16_machine_attach_block(machine, argv[3]))
+            {
+                printf("[bios] error: cannot attach disk %s\n", argv[3]);
+                la16_machine_dealloc(machine);
+                return 1;
+            }
+
+            printf("[bios] attached disk: %d sectors\n", machine->block->sector_cnt);
+        }
+
         printf("[bios] reading boot image header\n");
 
         /*